@@ -15,6 +15,16 @@ namespace aux
 		APP_STYLE_MAX_ENUMS,
 	};
 
+	enum
+	{
+		FRAME_LIFETIME_BAD_ENUM = -1,
+
+		FRAME_LIFETIME_CURRENT,
+		FRAME_LIFETIME_NEXT,
+
+		FRAME_LIFETIME_MAX_ENUMS,
+	};
+
 	struct app_handler_t
 	{
 		void* user_ptr;
@@ -34,5 +44,32 @@ namespace aux
 	void close_app();
 	void reshape_app(e32_t style, const size2_t& res);
 
+	// Safe to call from any thread, but frame memory must not be used after the frame it belongs to ends
+	void* alloc_frame_mem(size_t size, e32_t lifetime = FRAME_LIFETIME_CURRENT);
+
 	extern app_handler_t app_handler;
+
+	// Allocator policy for containers that live no longer than the frame lifetime
+	class frame_allocator_t
+	{
+	public:
+
+		explicit frame_allocator_t(e32_t lifetime_ = FRAME_LIFETIME_CURRENT)
+		{
+			lifetime = lifetime_;
+		}
+
+		void* alloc(size_t size)
+		{
+			return alloc_frame_mem(size, lifetime);
+		}
+
+		void free(void*)
+		{
+		}
+
+	private:
+
+		e32_t lifetime;
+	};
 }
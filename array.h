@@ -0,0 +1,286 @@
+#pragma once
+
+#include "base.h"
+
+#pragma warning(push, 0)
+
+#include <new>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	struct double_growth_t
+	{
+		static size_t get_capacity(size_t capacity, size_t required)
+		{
+			return max_of<size_t>(max_of<size_t>(capacity * 2, 8), required);
+		}
+	};
+
+	struct half_growth_t
+	{
+		static size_t get_capacity(size_t capacity, size_t required)
+		{
+			return max_of<size_t>(max_of<size_t>(capacity + capacity / 2, 8), required);
+		}
+	};
+
+	// Items are relocated with copy_mem and move_mem instead of constructors, so T must be trivially relocatable
+	template<typename T, size_t inline_count = 0, typename allocator_t = mem_allocator_t, typename growth_t = double_growth_t>
+	class array_t
+	{
+	public:
+
+		static_assert(alignof(T) <= 16, "array_t items can not be aligned above 16 bytes");
+
+		array_t(const array_t&) = delete;
+		array_t& operator = (const array_t&) = delete;
+
+		explicit array_t(const allocator_t& allocator_ = allocator_t()) : allocator(allocator_)
+		{
+			items = get_inline_items();
+			count = 0;
+			capacity = inline_count;
+		}
+
+		~array_t()
+		{
+			clear();
+			release_items();
+		}
+
+		T& operator [] (size_t index)
+		{
+			AUX_DEBUG_ASSERT(index < count);
+
+			return items[index];
+		}
+
+		const T& operator [] (size_t index) const
+		{
+			AUX_DEBUG_ASSERT(index < count);
+
+			return items[index];
+		}
+
+		T* begin()
+		{
+			return items;
+		}
+
+		T* end()
+		{
+			return items + count;
+		}
+
+		const T* begin() const
+		{
+			return items;
+		}
+
+		const T* end() const
+		{
+			return items + count;
+		}
+
+		T* get_data()
+		{
+			return items;
+		}
+
+		const T* get_data() const
+		{
+			return items;
+		}
+
+		size_t get_count() const
+		{
+			return count;
+		}
+
+		size_t get_capacity() const
+		{
+			return capacity;
+		}
+
+		bool is_empty() const
+		{
+			return count == 0;
+		}
+
+		T& get_last()
+		{
+			AUX_DEBUG_ASSERT(count > 0);
+
+			return items[count - 1];
+		}
+
+		T& push(const T& value)
+		{
+			if (count == capacity)
+			{
+				// The value may live inside the array, so copy it out before relocating
+				T copy(value);
+				relocate(growth_t::get_capacity(capacity, count + 1));
+				return *new (items + count++) T(copy);
+			}
+
+			return *new (items + count++) T(value);
+		}
+
+		T* push_many(size_t size)
+		{
+			if (count + size > capacity)
+			{
+				relocate(growth_t::get_capacity(capacity, count + size));
+			}
+
+			T* first = items + count;
+
+			for (size_t i = 0; i < size; ++i)
+			{
+				new (first + i) T();
+			}
+
+			count += size;
+			return first;
+		}
+
+		void pop()
+		{
+			AUX_DEBUG_ASSERT(count > 0);
+
+			items[--count].~T();
+		}
+
+		T& insert(size_t index, const T& value)
+		{
+			AUX_DEBUG_ASSERT(index <= count);
+
+			T copy(value);
+
+			if (count == capacity)
+			{
+				relocate(growth_t::get_capacity(capacity, count + 1));
+			}
+
+			move_mem(items + index, items + index + 1, sizeof(T) * (count - index));
+			++count;
+			return *new (items + index) T(copy);
+		}
+
+		void erase(size_t index)
+		{
+			AUX_DEBUG_ASSERT(index < count);
+
+			items[index].~T();
+			--count;
+			move_mem(items + index + 1, items + index, sizeof(T) * (count - index));
+		}
+
+		// Fills the hole with the last item instead of shifting the tail
+		void erase_swap(size_t index)
+		{
+			AUX_DEBUG_ASSERT(index < count);
+
+			items[index].~T();
+			--count;
+
+			if (index != count)
+			{
+				copy_mem(items + count, items + index, sizeof(T));
+			}
+		}
+
+		void clear()
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				items[i].~T();
+			}
+
+			count = 0;
+		}
+
+		void resize(size_t size)
+		{
+			if (size > count)
+			{
+				push_many(size - count);
+				return;
+			}
+
+			while (count > size)
+			{
+				pop();
+			}
+		}
+
+		void reserve(size_t size)
+		{
+			if (size > capacity)
+			{
+				relocate(size);
+			}
+		}
+
+		void shrink()
+		{
+			if ((capacity > inline_count) && (count < capacity))
+			{
+				relocate(count);
+			}
+		}
+
+	private:
+
+		T* items;
+		size_t count;
+		size_t capacity;
+		allocator_t allocator;
+		alignas(alignof(T)) u8_t inline_items[(inline_count > 0) ? sizeof(T) * inline_count : 1];
+
+		T* get_inline_items()
+		{
+			return (T*)inline_items;
+		}
+
+		void release_items()
+		{
+			if (items != get_inline_items())
+			{
+				allocator.free(items);
+			}
+		}
+
+		// Shrinking below the inline count moves the items back into the inline storage
+		void relocate(size_t new_capacity)
+		{
+			T* new_items = get_inline_items();
+
+			if (new_capacity > inline_count)
+			{
+				new_items = (T*)allocator.alloc(sizeof(T) * new_capacity);
+			}
+			else
+			{
+				new_capacity = inline_count;
+			}
+
+			if (new_items == items)
+			{
+				return;
+			}
+
+			if (count > 0)
+			{
+				copy_mem(items, new_items, sizeof(T) * count);
+			}
+
+			release_items();
+			items = new_items;
+			capacity = new_capacity;
+		}
+	};
+}
@@ -59,6 +59,86 @@ namespace aux
 	typedef double f64_t;
 	typedef int32_t e32_t;
 
+	enum
+	{
+		MEM_BACKEND_BAD_ENUM = -1,
+
+		MEM_BACKEND_SYSTEM,
+		MEM_BACKEND_CACHING,
+
+		MEM_BACKEND_MAX_ENUMS
+	};
+
+	enum
+	{
+		MEM_TAG_BAD_ENUM = -1,
+
+		MEM_TAG_GENERAL,
+		MEM_TAG_APPLICATION,
+		MEM_TAG_GRAPHICS,
+		MEM_TAG_AUDIO,
+		MEM_TAG_INPUT,
+		MEM_TAG_UNICODE,
+		MEM_TAG_ARENA,
+		MEM_TAG_POOL,
+		MEM_TAG_USER0,
+		MEM_TAG_USER1,
+		MEM_TAG_USER2,
+		MEM_TAG_USER3,
+		MEM_TAG_USER4,
+		MEM_TAG_USER5,
+		MEM_TAG_USER6,
+		MEM_TAG_USER7,
+
+		MEM_TAG_MAX_ENUMS
+	};
+
+	enum
+	{
+		CPU_FEATURE_BAD_ENUM = -1,
+
+		CPU_FEATURE_AVX2,
+		CPU_FEATURE_AVX512,
+
+		CPU_FEATURE_MAX_ENUMS
+	};
+
+	const size_t cache_line_size = 64;
+
+	// Bucket i counts allocations of up to (16 << i) bytes, the last one counts the rest
+	const i32_t mem_histogram_size = 16;
+
+	struct mem_tag_stats_t
+	{
+		i64_t live_bytes;
+		i64_t peak_bytes;
+		u64_t alloc_count;
+		u64_t histogram[mem_histogram_size];
+	};
+
+	const i32_t mem_site_max_frames = 16;
+
+	// Bytes are estimated from sampled allocations, so small sites may be missing
+	struct mem_site_t
+	{
+		i64_t live_bytes;
+		u64_t sample_count;
+		u32_t frame_count;
+		void* frames[mem_site_max_frames];
+	};
+
+	// Returns the number of bytes released while trying to free at least size bytes
+	typedef size_t(*mem_reclaim_handler_t)(size_t size, void* user_ptr);
+
+	struct mem_stats_t
+	{
+		i64_t live_bytes;
+		i64_t peak_bytes;
+		i64_t huge_live_bytes;
+		i64_t huge_backed_bytes;
+		mem_tag_stats_t tags[MEM_TAG_MAX_ENUMS];
+	};
+
 	#if defined(AUX_DEBUG_ON)
 	void report_debug_error__SHOULD_NOT_BE_USED_DIRECTLY(const wchar_t message[]);
 	void begin_debug_memory_guard__SHOULD_NOT_BE_USED_DIRECTLY();
@@ -105,12 +185,191 @@ namespace aux
 		return value;
 	}
 
+	// Wide register features only count when the OS also saves their state
+	bool has_cpu_feature(e32_t feature);
+
+	e32_t get_mem_backend();
+	bool select_mem_backend(e32_t backend);
+
+	void get_mem_stats(mem_stats_t& stats);
+
+	// One allocation is sampled per interval of allocated bytes, zero turns sampling off
+	size_t get_mem_sample_interval();
+	void set_mem_sample_interval(size_t size);
+	u32_t get_mem_sites(mem_site_t sites[], u32_t max_sites);
+	void report_mem_sites(u32_t max_sites);
+
+	// Zero disables a limit, allocations past the hard limit are fatal once reclaiming fails
+	// Handlers run on whichever thread allocates past a limit, so they must not take locks that thread may hold
+	void set_mem_budget(size_t soft_limit, size_t hard_limit);
+	bool add_mem_reclaimer(mem_reclaim_handler_t handler, void* user_ptr, i32_t priority);
+	void remove_mem_reclaimer(mem_reclaim_handler_t handler, void* user_ptr);
+	size_t reclaim_mem(size_t size);
+
 	void* alloc_mem(size_t size);
 	void* zalloc_mem(size_t size);
+	void* alloc_mem_tagged(size_t size, e32_t tag);
+	void* zalloc_mem_tagged(size_t size, e32_t tag);
 	void free_mem(void* mem);
+	void* alloc_mem_aligned(size_t size, size_t alignment, e32_t tag = MEM_TAG_GENERAL);
+	void* zalloc_mem_aligned(size_t size, size_t alignment, e32_t tag = MEM_TAG_GENERAL);
+	void free_mem_aligned(void* mem);
+	void* alloc_mem_huge(size_t size, e32_t tag = MEM_TAG_GENERAL);
+	void free_mem_huge(void* mem);
+
+	// Only huge allocations take a node, free them with free_mem_huge; alloc_mem keeps the OS first touch placement
+	// and ignores the thread node, which only stands in for a negative node here
+	u32_t get_numa_node_count();
+	i32_t get_thread_numa_node();
+	void set_thread_numa_node(i32_t node);
+	void* alloc_mem_huge_on_node(size_t size, i32_t node = -1, e32_t tag = MEM_TAG_GENERAL);
+	size_t get_mem_stream_threshold();
+	void set_mem_stream_threshold(size_t size);
+
 	void copy_mem(const void* mem_src, void* mem_dst, size_t size);
 	void move_mem(const void* mem_src, void* mem_dst, size_t size);
 	void fill_mem(void* mem, u8_t value, size_t size);
 	void zero_mem(void* mem, size_t size);
 	i32_t compare_mem(const void* mem1, const void* mem2, size_t size);
+
+	struct arena_t;
+
+	arena_t* create_arena(size_t capacity);
+	void destroy_arena(arena_t* arena);
+
+	void* push_arena(arena_t* arena, size_t size);
+	void* push_arena_zeroed(arena_t* arena, size_t size);
+	void* push_arena_aligned(arena_t* arena, size_t size, size_t alignment);
+
+	size_t get_arena_marker(const arena_t* arena);
+	void rewind_arena(arena_t* arena, size_t marker);
+	void reset_arena(arena_t* arena);
+
+	struct vm_buffer_t;
+
+	vm_buffer_t* create_vm_buffer(size_t capacity, e32_t tag = MEM_TAG_GENERAL);
+	void destroy_vm_buffer(vm_buffer_t* buffer);
+
+	void* get_vm_buffer_data(const vm_buffer_t* buffer);
+	size_t get_vm_buffer_size(const vm_buffer_t* buffer);
+	size_t get_vm_buffer_capacity(const vm_buffer_t* buffer);
+
+	void resize_vm_buffer(vm_buffer_t* buffer, size_t size);
+	void* grow_vm_buffer(vm_buffer_t* buffer, size_t size);
+
+	struct slab_pool_t;
+
+	slab_pool_t* create_slab_pool(size_t item_size);
+	void destroy_slab_pool(slab_pool_t* pool);
+	void* alloc_slab_item(slab_pool_t* pool);
+	void free_slab_item(slab_pool_t* pool, void* item);
+
+	void* alloc_small_mem(size_t size);
+	void free_small_mem(void* mem, size_t size);
+
+	class arena_scope_t
+	{
+	public:
+
+		arena_scope_t(const arena_scope_t&) = delete;
+		arena_scope_t& operator = (const arena_scope_t&) = delete;
+
+		explicit arena_scope_t(arena_t* arena_)
+		{
+			arena = arena_;
+			marker = get_arena_marker(arena_);
+		}
+
+		~arena_scope_t()
+		{
+			rewind_arena(arena, marker);
+		}
+
+	private:
+
+		arena_t* arena;
+		size_t marker;
+	};
+
+	template<typename T>
+	class pool_t
+	{
+	public:
+
+		pool_t(const pool_t&) = delete;
+		pool_t& operator = (const pool_t&) = delete;
+
+		pool_t()
+		{
+			slabs = create_slab_pool(sizeof(T));
+		}
+
+		~pool_t()
+		{
+			destroy_slab_pool(slabs);
+		}
+
+		T* alloc_item()
+		{
+			return (T*)alloc_slab_item(slabs);
+		}
+
+		void free_item(T* item)
+		{
+			free_slab_item(slabs, item);
+		}
+
+	private:
+
+		slab_pool_t* slabs;
+	};
+
+	// Allocator policies used by the containers, blocks come back 16-byte aligned
+	class mem_allocator_t
+	{
+	public:
+
+		explicit mem_allocator_t(e32_t tag_ = MEM_TAG_GENERAL)
+		{
+			tag = tag_;
+		}
+
+		void* alloc(size_t size)
+		{
+			return alloc_mem_tagged(size, tag);
+		}
+
+		void free(void* mem)
+		{
+			free_mem(mem);
+		}
+
+	private:
+
+		e32_t tag;
+	};
+
+	// Arena memory is only released by rewinding the arena, so free does nothing
+	class arena_allocator_t
+	{
+	public:
+
+		explicit arena_allocator_t(arena_t* arena_)
+		{
+			arena = arena_;
+		}
+
+		void* alloc(size_t size)
+		{
+			return push_arena(arena, size);
+		}
+
+		void free(void*)
+		{
+		}
+
+	private:
+
+		arena_t* arena;
+	};
 }
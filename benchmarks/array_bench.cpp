@@ -0,0 +1,256 @@
+#include "bench.h"
+#include "../array.h"
+
+#pragma warning(push, 0)
+
+#include <vector>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	static const size_t min_bench_count = 1 << 6;
+	static const size_t max_bench_count = 1 << 22;
+	// Every case does about this many operations per run, split over as many containers as it takes
+	static const size_t ops_per_run = 1 << 24;
+	static const size_t small_array_count = 8;
+	static const size_t insert_count = 1 << 12;
+	static const u32_t runs_per_case = 5;
+
+	// Big enough that relocation cost shows next to the push itself
+	struct bench_item_t
+	{
+		u64_t values[8];
+	};
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static void print_case(const char* name, size_t count, size_t ops, f64_t aux_seconds, f64_t std_seconds)
+	{
+		f64_t aux_ns = aux_seconds * 1e9 / (f64_t)ops;
+		f64_t std_ns = std_seconds * 1e9 / (f64_t)ops;
+		printf("%-16s %10zu  %8.2f %8.2f  %6.2fx\n", name, count, aux_ns, std_ns, std_ns / aux_ns);
+	}
+
+	template<typename T>
+	static void run_push(const char* name, size_t count)
+	{
+		size_t rounds = max_of<size_t>(ops_per_run / count, 1);
+
+		f64_t aux_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				array_t<T> items;
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					items.push(T());
+				}
+
+				bench_sink += items.get_count();
+			}
+		});
+
+		f64_t std_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				std::vector<T> items;
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					items.push_back(T());
+				}
+
+				bench_sink += items.size();
+			}
+		});
+
+		print_case(name, count, rounds * count, aux_seconds, std_seconds);
+	}
+
+	static void run_push_reserved(size_t count)
+	{
+		size_t rounds = max_of<size_t>(ops_per_run / count, 1);
+
+		f64_t aux_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				array_t<u32_t> items;
+				items.reserve(count);
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					items.push((u32_t)i);
+				}
+
+				bench_sink += items.get_count();
+			}
+		});
+
+		f64_t std_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				std::vector<u32_t> items;
+				items.reserve(count);
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					items.push_back((u32_t)i);
+				}
+
+				bench_sink += items.size();
+			}
+		});
+
+		print_case("push reserved", count, rounds * count, aux_seconds, std_seconds);
+	}
+
+	static void run_iterate(size_t count)
+	{
+		size_t rounds = max_of<size_t>(ops_per_run / count, 1);
+		array_t<u32_t> aux_items;
+		std::vector<u32_t> std_items;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			aux_items.push((u32_t)i);
+			std_items.push_back((u32_t)i);
+		}
+
+		f64_t aux_seconds = time_best_of(runs_per_case, [&]()
+		{
+			u64_t sum = 0;
+			size_t items_count = aux_items.get_count();
+
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				for (size_t i = 0; i < items_count; ++i)
+				{
+					sum += aux_items[i];
+				}
+			}
+
+			bench_sink += sum;
+		});
+
+		f64_t std_seconds = time_best_of(runs_per_case, [&]()
+		{
+			u64_t sum = 0;
+			size_t items_count = std_items.size();
+
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				for (size_t i = 0; i < items_count; ++i)
+				{
+					sum += std_items[i];
+				}
+			}
+
+			bench_sink += sum;
+		});
+
+		print_case("iterate", count, rounds * count, aux_seconds, std_seconds);
+	}
+
+	// Many short lived arrays that never outgrow their inline items, the case inline_count is for
+	static void run_small_arrays()
+	{
+		size_t rounds = ops_per_run / small_array_count;
+
+		f64_t aux_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				array_t<u32_t, small_array_count> items;
+
+				for (size_t i = 0; i < small_array_count; ++i)
+				{
+					items.push((u32_t)(r + i));
+				}
+
+				bench_sink += items[small_array_count - 1];
+			}
+		});
+
+		f64_t std_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				std::vector<u32_t> items;
+
+				for (size_t i = 0; i < small_array_count; ++i)
+				{
+					items.push_back((u32_t)(r + i));
+				}
+
+				bench_sink += items[small_array_count - 1];
+			}
+		});
+
+		print_case("small inline", small_array_count, rounds * small_array_count, aux_seconds, std_seconds);
+	}
+
+	// Inserting in the middle and erasing from the front both shift the tail, so this measures move_mem against element moves
+	static void run_insert_erase()
+	{
+		f64_t aux_seconds = time_best_of(runs_per_case, [&]()
+		{
+			array_t<u32_t> items;
+
+			for (size_t i = 0; i < insert_count; ++i)
+			{
+				items.insert(items.get_count() / 2, (u32_t)i);
+			}
+
+			while (!items.is_empty())
+			{
+				items.erase(0);
+			}
+		});
+
+		f64_t std_seconds = time_best_of(runs_per_case, [&]()
+		{
+			std::vector<u32_t> items;
+
+			for (size_t i = 0; i < insert_count; ++i)
+			{
+				items.insert(items.begin() + items.size() / 2, (u32_t)i);
+			}
+
+			while (!items.empty())
+			{
+				items.erase(items.begin());
+			}
+		});
+
+		print_case("insert erase", insert_count, insert_count * 2, aux_seconds, std_seconds);
+	}
+}
+
+// Times are nanoseconds per operation, the last column is how many times faster array_t is
+int main(int, char*[])
+{
+	using namespace aux;
+
+	printf("%-16s %10s  %8s %8s  %7s\n", "case", "count", "array_t", "vector", "ratio");
+
+	for (size_t count = min_bench_count; count <= max_bench_count; count *= 16)
+	{
+		run_push<u32_t>("push u32", count);
+		run_push<bench_item_t>("push 64 byte", count);
+		run_push_reserved(count);
+		run_iterate(count);
+	}
+
+	run_small_arrays();
+	run_insert_erase();
+	return 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../base.h"
+
+#pragma warning(push, 0)
+
+#include <stdio.h>
+
+#define WIN32_LEAN_AND_MEAN
+#define STRICT
+#include <windows.h>
+
+#pragma warning(pop)
+
+// Benchmarks are console programs, build each one with the library sources but without windows__main.cpp
+namespace aux
+{
+	// Results are folded in here so the optimizer cannot drop the measured work
+	static volatile u64_t bench_sink = 0;
+
+	inline f64_t get_bench_seconds()
+	{
+		static LARGE_INTEGER frequency = {};
+
+		if (frequency.QuadPart == 0)
+		{
+			QueryPerformanceFrequency(&frequency);
+		}
+
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return (f64_t)counter.QuadPart / (f64_t)frequency.QuadPart;
+	}
+
+	// Runs func a few times and keeps the fastest, which filters out scheduler and page fault noise
+	template<typename F>
+	f64_t time_best_of(u32_t runs, F func)
+	{
+		f64_t best = 0.0;
+
+		for (u32_t i = 0; i < runs; ++i)
+		{
+			f64_t start = get_bench_seconds();
+			func();
+			f64_t elapsed = get_bench_seconds() - start;
+
+			if ((i == 0) || (elapsed < best))
+			{
+				best = elapsed;
+			}
+		}
+
+		return best;
+	}
+}
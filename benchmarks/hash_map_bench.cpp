@@ -0,0 +1,260 @@
+#include "bench.h"
+#include "../array.h"
+#include "../hash_map.h"
+
+#pragma warning(push, 0)
+
+#include <stdlib.h>
+#include <unordered_map>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	static const size_t min_bench_count = 1 << 10;
+	static const size_t default_max_count = 1 << 22;
+	static const size_t max_bench_count = 100000000;
+	// Small maps repeat their case until about this many operations are timed
+	static const size_t ops_per_run = 1 << 22;
+	static const u32_t runs_per_case = 3;
+
+	// The standard map gets the same hash so the comparison is about the table and not the hash function
+	struct std_hash_t
+	{
+		size_t operator () (u64_t key) const
+		{
+			return (size_t)mix_hash(key);
+		}
+	};
+
+	typedef hash_map_t<u64_t, u64_t> aux_map_t;
+	typedef std::unordered_map<u64_t, u64_t, std_hash_t> std_map_t;
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static void print_case(const char* name, size_t count, f64_t aux_seconds, f64_t std_seconds, size_t ops)
+	{
+		f64_t aux_ns = aux_seconds * 1e9 / (f64_t)ops;
+		f64_t std_ns = std_seconds * 1e9 / (f64_t)ops;
+		printf("%-16s %10zu  %8.2f %8.2f  %6.2fx\n", name, count, aux_ns, std_ns, std_ns / aux_ns);
+	}
+
+	// Present keys are even and missing keys odd, so a miss can never hit by accident
+	static void fill_keys(array_t<u64_t>& keys, array_t<u64_t>& misses, size_t count)
+	{
+		u64_t seed = 0x2545f4914f6cdd1dull;
+		keys.clear();
+		misses.clear();
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			keys.push(seed & ~1ull);
+			misses.push(seed | 1ull);
+		}
+	}
+
+	static void run_count(size_t count)
+	{
+		array_t<u64_t> keys;
+		array_t<u64_t> misses;
+		fill_keys(keys, misses, count);
+		size_t rounds = max_of<size_t>(ops_per_run / count, 1);
+		size_t ops = rounds * count;
+
+		f64_t aux_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				aux_map_t map;
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					map.insert(keys[i], i);
+				}
+
+				bench_sink += map.get_count();
+			}
+		});
+
+		f64_t std_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				std_map_t map;
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					map.emplace(keys[i], i);
+				}
+
+				bench_sink += map.size();
+			}
+		});
+
+		print_case("insert", count, aux_seconds, std_seconds, ops);
+
+		aux_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				aux_map_t map;
+				map.reserve(count);
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					map.insert(keys[i], i);
+				}
+
+				bench_sink += map.get_count();
+			}
+		});
+
+		std_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				std_map_t map;
+				map.reserve(count);
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					map.emplace(keys[i], i);
+				}
+
+				bench_sink += map.size();
+			}
+		});
+
+		print_case("insert reserved", count, aux_seconds, std_seconds, ops);
+
+		// The probe cases share one filled map per side
+		aux_map_t aux_map;
+		std_map_t std_map;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			aux_map.insert(keys[i], i);
+			std_map.emplace(keys[i], i);
+		}
+
+		aux_seconds = time_best_of(runs_per_case, [&]()
+		{
+			u64_t sum = 0;
+
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					sum += *aux_map.find(keys[i]);
+				}
+			}
+
+			bench_sink += sum;
+		});
+
+		std_seconds = time_best_of(runs_per_case, [&]()
+		{
+			u64_t sum = 0;
+
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					sum += std_map.find(keys[i])->second;
+				}
+			}
+
+			bench_sink += sum;
+		});
+
+		print_case("probe hit", count, aux_seconds, std_seconds, ops);
+
+		aux_seconds = time_best_of(runs_per_case, [&]()
+		{
+			u64_t found = 0;
+
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					found += (aux_map.find(misses[i]) != nullptr) ? 1 : 0;
+				}
+			}
+
+			bench_sink += found;
+		});
+
+		std_seconds = time_best_of(runs_per_case, [&]()
+		{
+			u64_t found = 0;
+
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					found += (std_map.find(misses[i]) != std_map.end()) ? 1 : 0;
+				}
+			}
+
+			bench_sink += found;
+		});
+
+		print_case("probe miss", count, aux_seconds, std_seconds, ops);
+
+		// Removing and adding back keeps the size steady while leaving deleted slots behind
+		aux_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					aux_map.remove(keys[i]);
+					aux_map.insert(keys[i], i);
+				}
+			}
+		});
+
+		std_seconds = time_best_of(runs_per_case, [&]()
+		{
+			for (size_t r = 0; r < rounds; ++r)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					std_map.erase(keys[i]);
+					std_map.emplace(keys[i], i);
+				}
+			}
+		});
+
+		print_case("remove insert", count, aux_seconds, std_seconds, ops);
+	}
+}
+
+// Times are nanoseconds per operation, the last column is how many times faster hash_map_t is.
+// Pass a key count up to 100M to go past 4M, that count is always run last, and the standard map
+// needs several gigabytes at the top end
+int main(int argc, char* argv[])
+{
+	using namespace aux;
+
+	size_t max_count = (argc > 1) ? min_of((size_t)atoll(argv[1]), max_bench_count) : default_max_count;
+	max_count = max_of(max_count, min_bench_count);
+	size_t count = min_bench_count;
+
+	printf("%-16s %10s  %8s %8s  %7s\n", "case", "count", "hash_map", "std", "ratio");
+
+	for (; count < max_count; count *= 16)
+	{
+		run_count(count);
+	}
+
+	run_count(max_count);
+	return 0;
+}
@@ -0,0 +1,197 @@
+#include "bench.h"
+#include "../thread.h"
+
+#pragma warning(push, 0)
+
+#include <stdlib.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	static const u32_t max_bench_threads = 32;
+	static const u32_t ops_per_thread = 1 << 21;
+	// Each thread keeps this many blocks alive and replaces a random one per step
+	static const u32_t live_slot_count = 4096;
+	static const u32_t runs_per_count = 3;
+
+	typedef void*(*bench_alloc_t)(size_t size);
+	typedef void(*bench_free_t)(void* mem);
+
+	struct heap_bench_t
+	{
+		bench_alloc_t alloc_func;
+		bench_free_t free_func;
+		volatile LONG ready;
+		volatile LONG go;
+	};
+
+	struct heap_worker_t
+	{
+		heap_bench_t* bench;
+		u64_t seed;
+		void* slots[live_slot_count];
+	};
+
+	// The system allocator goes through volatile pointers so neither side gets inlined into the loop
+	static void* (*volatile system_alloc)(size_t) = &malloc;
+	static void (*volatile system_free)(void*) = &free;
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static void* alloc_system(size_t size)
+	{
+		return system_alloc(size);
+	}
+
+	static void free_system(void* mem)
+	{
+		system_free(mem);
+	}
+
+	static u64_t get_next_random(u64_t& seed)
+	{
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		return seed;
+	}
+
+	// Mostly small blocks with a long tail, roughly what the engine asks for
+	static size_t get_block_size(u64_t random)
+	{
+		u32_t shift = (u32_t)(random & 0x3f);
+
+		if (shift == 0)
+		{
+			return 4096 + (size_t)((random >> 8) & 0xffff);
+		}
+
+		size_t base = (size_t)16 << (shift % 6);
+		return base + (size_t)((random >> 8) % base);
+	}
+
+	static i32_t run_heap_worker(void* user_ptr)
+	{
+		heap_worker_t* worker = (heap_worker_t*)user_ptr;
+		heap_bench_t* bench = worker->bench;
+		bench_alloc_t alloc_func = bench->alloc_func;
+		bench_free_t free_func = bench->free_func;
+		u64_t seed = worker->seed;
+
+		InterlockedIncrement(&bench->ready);
+
+		while (bench->go == 0)
+		{
+			suspend_current_thread(0);
+		}
+
+		for (u32_t i = 0; i < ops_per_thread; ++i)
+		{
+			u64_t random = get_next_random(seed);
+			void** slot = &worker->slots[(u32_t)(random >> 40) & (live_slot_count - 1)];
+
+			if (*slot != nullptr)
+			{
+				free_func(*slot);
+			}
+
+			*slot = alloc_func(get_block_size(random));
+			*(u8_t*)*slot = (u8_t)i;
+		}
+
+		for (u32_t i = 0; i < live_slot_count; ++i)
+		{
+			if (worker->slots[i] != nullptr)
+			{
+				free_func(worker->slots[i]);
+				worker->slots[i] = nullptr;
+			}
+		}
+
+		return 0;
+	}
+
+	// Returns allocations per second summed over all threads
+	static f64_t run_threads(heap_bench_t* bench, heap_worker_t* workers, u32_t thread_count)
+	{
+		thread_t* threads[max_bench_threads];
+		bench->ready = 0;
+		bench->go = 0;
+
+		for (u32_t i = 0; i < thread_count; ++i)
+		{
+			workers[i].bench = bench;
+			workers[i].seed = 0x9e3779b97f4a7c15ull * (i + 1);
+			threads[i] = start_thread(&run_heap_worker, &workers[i]);
+		}
+
+		while (bench->ready != (LONG)thread_count)
+		{
+			suspend_current_thread(0);
+		}
+
+		f64_t start = get_bench_seconds();
+		InterlockedExchange(&bench->go, 1);
+
+		for (u32_t i = 0; i < thread_count; ++i)
+		{
+			wait_thread(threads[i]);
+			free_thread(threads[i]);
+		}
+
+		f64_t elapsed = get_bench_seconds() - start;
+		return ((f64_t)ops_per_thread * thread_count) / elapsed;
+	}
+
+	static f64_t run_best_of(heap_bench_t* bench, heap_worker_t* workers, u32_t thread_count)
+	{
+		f64_t best = 0.0;
+
+		for (u32_t i = 0; i < runs_per_count; ++i)
+		{
+			best = max_of(best, run_threads(bench, workers, thread_count));
+		}
+
+		return best;
+	}
+}
+
+// Pass a thread count to stop the sweep early; the library side uses the caching backend, the other side plain malloc
+int main(int argc, char* argv[])
+{
+	using namespace aux;
+
+	if (!select_mem_backend(MEM_BACKEND_CACHING))
+	{
+		printf("caching backend unavailable\n");
+		return 1;
+	}
+
+	u32_t max_threads = (argc > 1) ? min_of((u32_t)atoi(argv[1]), max_bench_threads) : max_bench_threads;
+	heap_worker_t* workers = (heap_worker_t*)zalloc_mem(sizeof(heap_worker_t) * max_bench_threads);
+	heap_bench_t caching = {};
+	caching.alloc_func = &alloc_mem;
+	caching.free_func = &free_mem;
+	heap_bench_t system = {};
+	system.alloc_func = &alloc_system;
+	system.free_func = &free_system;
+
+	printf("%u allocations per thread, %u live blocks per thread, millions of allocations per second\n", ops_per_thread, live_slot_count);
+	printf("%8s  %10s %10s\n", "threads", "caching", "system");
+
+	for (u32_t threads = 1; threads <= max_threads; threads *= 2)
+	{
+		f64_t caching_rate = run_best_of(&caching, workers, threads);
+		f64_t system_rate = run_best_of(&system, workers, threads);
+
+		printf("%8u  %10.2f %10.2f\n", threads, caching_rate / 1e6, system_rate / 1e6);
+	}
+
+	free_mem(workers);
+	return 0;
+}
@@ -0,0 +1,142 @@
+#include "bench.h"
+
+#pragma warning(push, 0)
+
+#include <stdlib.h>
+#include <string.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	static const size_t min_bench_size = 1;
+	static const size_t max_bench_size = 64 * 1024 * 1024;
+	// Every size moves about this many bytes per run, small sizes are capped by call count instead
+	static const size_t bytes_per_run = 256 * 1024 * 1024;
+	static const size_t max_calls_per_run = 1 << 22;
+	static const u32_t runs_per_size = 5;
+
+	// Calling libc through these keeps it out of line like the library calls, and stops repeated calls being folded
+	static void* (*volatile libc_copy)(void*, const void*, size_t) = &memcpy;
+	static void* (*volatile libc_fill)(void*, int, size_t) = &memset;
+	static int (*volatile libc_compare)(const void*, const void*, size_t) = &memcmp;
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static size_t get_call_count(size_t size)
+	{
+		return max_of<size_t>(min_of<size_t>(bytes_per_run / size, max_calls_per_run), 1);
+	}
+
+	static f64_t get_gbytes_per_sec(size_t size, size_t calls, f64_t seconds)
+	{
+		return ((f64_t)size * (f64_t)calls) / (seconds * 1e9);
+	}
+
+	static void run_size(u8_t* src, u8_t* dst, size_t size)
+	{
+		size_t calls = get_call_count(size);
+
+		f64_t copy_aux = time_best_of(runs_per_size, [&]()
+		{
+			for (size_t i = 0; i < calls; ++i)
+			{
+				copy_mem(src, dst, size);
+			}
+		});
+
+		f64_t copy_libc = time_best_of(runs_per_size, [&]()
+		{
+			for (size_t i = 0; i < calls; ++i)
+			{
+				libc_copy(dst, src, size);
+			}
+		});
+
+		f64_t fill_aux = time_best_of(runs_per_size, [&]()
+		{
+			for (size_t i = 0; i < calls; ++i)
+			{
+				fill_mem(dst, (u8_t)i, size);
+			}
+		});
+
+		f64_t fill_libc = time_best_of(runs_per_size, [&]()
+		{
+			for (size_t i = 0; i < calls; ++i)
+			{
+				libc_fill(dst, (i32_t)(u8_t)i, size);
+			}
+		});
+
+		// Equal buffers make both sides scan the whole range
+		copy_mem(src, dst, size);
+
+		f64_t compare_aux = time_best_of(runs_per_size, [&]()
+		{
+			i32_t result = 0;
+
+			for (size_t i = 0; i < calls; ++i)
+			{
+				result |= compare_mem(src, dst, size);
+			}
+
+			bench_sink += (u64_t)result;
+		});
+
+		f64_t compare_libc = time_best_of(runs_per_size, [&]()
+		{
+			i32_t result = 0;
+
+			for (size_t i = 0; i < calls; ++i)
+			{
+				result |= libc_compare(src, dst, size);
+			}
+
+			bench_sink += (u64_t)result;
+		});
+
+		printf("%10zu  %8.2f %8.2f  %8.2f %8.2f  %8.2f %8.2f\n", size,
+			get_gbytes_per_sec(size, calls, copy_aux), get_gbytes_per_sec(size, calls, copy_libc),
+			get_gbytes_per_sec(size, calls, fill_aux), get_gbytes_per_sec(size, calls, fill_libc),
+			get_gbytes_per_sec(size, calls, compare_aux), get_gbytes_per_sec(size, calls, compare_libc));
+	}
+}
+
+// Sweeps powers of two and the sizes halfway between them, pass an offset to misalign the destination
+int main(int argc, char* argv[])
+{
+	using namespace aux;
+
+	size_t offset = (argc > 1) ? (size_t)atoi(argv[1]) : 0;
+	u8_t* src = (u8_t*)alloc_mem_huge(max_bench_size);
+	u8_t* dst = (u8_t*)alloc_mem_huge(max_bench_size + offset);
+
+	for (size_t i = 0; i < max_bench_size; ++i)
+	{
+		src[i] = (u8_t)(i * 31);
+	}
+
+	zero_mem(dst, max_bench_size + offset);
+
+	printf("copy, fill and compare in GB/s, destination offset %zu\n", offset);
+	printf("%10s  %8s %8s  %8s %8s  %8s %8s\n", "size", "copy", "memcpy", "fill", "memset", "compare", "memcmp");
+
+	for (size_t size = min_bench_size; size <= max_bench_size; size *= 2)
+	{
+		run_size(src, dst + offset, size);
+
+		if ((size >= 4) && (size < max_bench_size))
+		{
+			run_size(src, dst + offset, size + size / 2);
+		}
+	}
+
+	free_mem_huge(dst);
+	free_mem_huge(src);
+	return 0;
+}
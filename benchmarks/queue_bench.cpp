@@ -0,0 +1,246 @@
+#include "bench.h"
+#include "../queue.h"
+
+#pragma warning(push, 0)
+
+#include <stdlib.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	static const u32_t max_pair_count = 32;
+	static const u32_t items_per_thread = 1 << 20;
+	static const u32_t queue_capacity = 1024;
+	static const u32_t runs_per_count = 3;
+	static const u32_t max_spin_count = 256;
+
+	// Same ring behind a single lock, the baseline the lock free queue is meant to beat under contention
+	struct locked_queue_t
+	{
+		lock_t lock;
+		u64_t* items;
+		u32_t mask;
+		u32_t head;
+		u32_t tail;
+	};
+
+	struct queue_bench_t
+	{
+		mpmc_queue_t<u64_t>* queue;
+		locked_queue_t* locked;
+		volatile LONG ready;
+		volatile LONG go;
+		u64_t sums[max_pair_count];
+	};
+
+	struct queue_worker_t
+	{
+		queue_bench_t* bench;
+		u32_t index;
+	};
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static bool try_push_locked(locked_queue_t* queue, u64_t item)
+	{
+		lock_scope_t scope(queue->lock);
+
+		if (queue->tail - queue->head > queue->mask)
+		{
+			return false;
+		}
+
+		queue->items[queue->tail++ & queue->mask] = item;
+		return true;
+	}
+
+	static bool try_pop_locked(locked_queue_t* queue, u64_t& item)
+	{
+		lock_scope_t scope(queue->lock);
+
+		if (queue->tail == queue->head)
+		{
+			return false;
+		}
+
+		item = queue->items[queue->head++ & queue->mask];
+		return true;
+	}
+
+	// Threads can outnumber cores at the top of the sweep, so a full or empty queue backs off to yielding
+	static void back_off(u32_t& spin)
+	{
+		if (spin++ < max_spin_count)
+		{
+			_mm_pause();
+		}
+		else
+		{
+			suspend_current_thread(0);
+		}
+	}
+
+	static void wait_for_go(queue_bench_t* bench)
+	{
+		InterlockedIncrement(&bench->ready);
+
+		for (u32_t spin = 0; bench->go == 0;)
+		{
+			back_off(spin);
+		}
+	}
+
+	static i32_t run_producer(void* user_ptr)
+	{
+		queue_worker_t* worker = (queue_worker_t*)user_ptr;
+		queue_bench_t* bench = worker->bench;
+		u64_t base = (u64_t)worker->index * items_per_thread;
+		wait_for_go(bench);
+
+		for (u32_t i = 0; i < items_per_thread; ++i)
+		{
+			if (bench->queue != nullptr)
+			{
+				for (u32_t spin = 0; !bench->queue->try_push(base + i);)
+				{
+					back_off(spin);
+				}
+			}
+			else
+			{
+				for (u32_t spin = 0; !try_push_locked(bench->locked, base + i);)
+				{
+					back_off(spin);
+				}
+			}
+		}
+
+		return 0;
+	}
+
+	static i32_t run_consumer(void* user_ptr)
+	{
+		queue_worker_t* worker = (queue_worker_t*)user_ptr;
+		queue_bench_t* bench = worker->bench;
+		u64_t sum = 0;
+		u64_t item = 0;
+		wait_for_go(bench);
+
+		for (u32_t i = 0; i < items_per_thread; ++i)
+		{
+			if (bench->queue != nullptr)
+			{
+				for (u32_t spin = 0; !bench->queue->try_pop(item);)
+				{
+					back_off(spin);
+				}
+			}
+			else
+			{
+				for (u32_t spin = 0; !try_pop_locked(bench->locked, item);)
+				{
+					back_off(spin);
+				}
+			}
+
+			sum += item;
+		}
+
+		bench->sums[worker->index] = sum;
+		return 0;
+	}
+
+	// Returns items per second through the queue, pair_count producers feed as many consumers
+	static f64_t run_pairs(queue_bench_t* bench, u32_t pair_count)
+	{
+		queue_worker_t workers[max_pair_count];
+		thread_t* threads[max_pair_count * 2];
+		bench->ready = 0;
+		bench->go = 0;
+
+		for (u32_t i = 0; i < pair_count; ++i)
+		{
+			workers[i].bench = bench;
+			workers[i].index = i;
+			threads[i * 2] = start_thread(&run_producer, &workers[i]);
+			threads[i * 2 + 1] = start_thread(&run_consumer, &workers[i]);
+		}
+
+		while (bench->ready != (LONG)(pair_count * 2))
+		{
+			suspend_current_thread(0);
+		}
+
+		f64_t start = get_bench_seconds();
+		InterlockedExchange(&bench->go, 1);
+		u64_t sum = 0;
+
+		for (u32_t i = 0; i < pair_count * 2; ++i)
+		{
+			wait_thread(threads[i]);
+			free_thread(threads[i]);
+		}
+
+		f64_t elapsed = get_bench_seconds() - start;
+
+		for (u32_t i = 0; i < pair_count; ++i)
+		{
+			sum += bench->sums[i];
+		}
+
+		// Every item is popped exactly once, so the sums must add up to all the pushed values
+		u64_t total = (u64_t)pair_count * items_per_thread;
+		AUX_DEBUG_ASSERT(sum == total * (total - 1) / 2);
+		bench_sink += sum;
+
+		return (f64_t)total / elapsed;
+	}
+
+	static f64_t run_best_of(queue_bench_t* bench, u32_t pair_count)
+	{
+		f64_t best = 0.0;
+
+		for (u32_t i = 0; i < runs_per_count; ++i)
+		{
+			best = max_of(best, run_pairs(bench, pair_count));
+		}
+
+		return best;
+	}
+}
+
+// Pass a pair count to stop the sweep early, each pair is one producer and one consumer thread
+int main(int argc, char* argv[])
+{
+	using namespace aux;
+
+	u32_t max_pairs = (argc > 1) ? min_of((u32_t)atoi(argv[1]), max_pair_count) : max_pair_count;
+	mpmc_queue_t<u64_t> queue(queue_capacity);
+	locked_queue_t locked = {};
+	locked.items = (u64_t*)alloc_mem(sizeof(u64_t) * queue_capacity);
+	locked.mask = queue_capacity - 1;
+	queue_bench_t bench = {};
+
+	printf("%u items per thread, capacity %u, millions of items per second\n", items_per_thread, queue_capacity);
+	printf("%8s %8s  %10s %10s\n", "pairs", "threads", "mpmc", "locked");
+
+	for (u32_t pairs = 1; pairs <= max_pairs; pairs *= 2)
+	{
+		bench.queue = &queue;
+		bench.locked = nullptr;
+		f64_t lock_free = run_best_of(&bench, pairs);
+		bench.queue = nullptr;
+		bench.locked = &locked;
+		f64_t lock_based = run_best_of(&bench, pairs);
+
+		printf("%8u %8u  %10.2f %10.2f\n", pairs, pairs * 2, lock_free / 1e6, lock_based / 1e6);
+	}
+
+	free_mem(locked.items);
+	return 0;
+}
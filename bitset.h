@@ -0,0 +1,389 @@
+#pragma once
+
+#include "base.h"
+
+#pragma warning(push, 0)
+
+#include <intrin.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	const size_t invalid_bit_index = SIZE_MAX;
+
+	// Word array functions use AVX2 when the CPU supports it and fall back to SSE2 otherwise
+	void and_bits(u64_t* dst, const u64_t* src, size_t word_count);
+	void or_bits(u64_t* dst, const u64_t* src, size_t word_count);
+	void xor_bits(u64_t* dst, const u64_t* src, size_t word_count);
+	void and_not_bits(u64_t* dst, const u64_t* src, size_t word_count);
+	size_t count_bits(const u64_t* words, size_t word_count);
+	// Writes the bits that differ between lhs and rhs to diff and returns their count
+	size_t diff_bits(const u64_t* lhs, const u64_t* rhs, u64_t* diff, size_t word_count);
+	// Returns the first set bit at or after pos, or invalid_bit_index when there is none
+	size_t find_next_bit(const u64_t* words, size_t word_count, size_t pos);
+
+	inline size_t get_bit_word_count(size_t bit_count)
+	{
+		return (bit_count + 63) / 64;
+	}
+
+	inline u32_t find_lowest_bit(u64_t word)
+	{
+		unsigned long index;
+
+		#if defined(_M_X64)
+		_BitScanForward64(&index, word);
+		#else
+		if (!_BitScanForward(&index, (unsigned long)word))
+		{
+			_BitScanForward(&index, (unsigned long)(word >> 32));
+			index += 32;
+		}
+		#endif
+
+		return (u32_t)index;
+	}
+
+	template<typename func_t>
+	inline void for_each_bit(const u64_t* words, size_t word_count, func_t func)
+	{
+		for (size_t i = 0; i < word_count; ++i)
+		{
+			u64_t word = words[i];
+
+			while (word != 0)
+			{
+				func(i * 64 + find_lowest_bit(word));
+				word &= word - 1;
+			}
+		}
+	}
+
+	// Has no constructor so it can live in zeroed structs, a zeroed bitset_t has no bits set
+	template<size_t bit_count>
+	class bitset_t
+	{
+	public:
+
+		static const size_t word_count = (bit_count + 63) / 64;
+
+		bool test_bit(size_t index) const
+		{
+			AUX_DEBUG_ASSERT(index < bit_count);
+
+			return (words[index / 64] & ((u64_t)1 << (index % 64))) != 0;
+		}
+
+		void set_bit(size_t index)
+		{
+			AUX_DEBUG_ASSERT(index < bit_count);
+
+			words[index / 64] |= (u64_t)1 << (index % 64);
+		}
+
+		void clear_bit(size_t index)
+		{
+			AUX_DEBUG_ASSERT(index < bit_count);
+
+			words[index / 64] &= ~((u64_t)1 << (index % 64));
+		}
+
+		void assign_bit(size_t index, bool value)
+		{
+			if (value)
+			{
+				set_bit(index);
+			}
+			else
+			{
+				clear_bit(index);
+			}
+		}
+
+		void set_all()
+		{
+			fill_mem(words, 0xff, sizeof(words));
+
+			if (bit_count % 64 != 0)
+			{
+				words[word_count - 1] = ((u64_t)1 << (bit_count % 64)) - 1;
+			}
+		}
+
+		void clear()
+		{
+			zero_mem(words, sizeof(words));
+		}
+
+		size_t get_count() const
+		{
+			return count_bits(words, word_count);
+		}
+
+		bool is_empty() const
+		{
+			return find_next_bit(words, word_count, 0) == invalid_bit_index;
+		}
+
+		size_t find_first() const
+		{
+			return find_next_bit(words, word_count, 0);
+		}
+
+		size_t find_next(size_t pos) const
+		{
+			return (pos < bit_count) ? find_next_bit(words, word_count, pos) : invalid_bit_index;
+		}
+
+		template<typename func_t>
+		void for_each(func_t func) const
+		{
+			for_each_bit(words, word_count, func);
+		}
+
+		void and_with(const bitset_t& other)
+		{
+			and_bits(words, other.words, word_count);
+		}
+
+		void or_with(const bitset_t& other)
+		{
+			or_bits(words, other.words, word_count);
+		}
+
+		void xor_with(const bitset_t& other)
+		{
+			xor_bits(words, other.words, word_count);
+		}
+
+		void and_not_with(const bitset_t& other)
+		{
+			and_not_bits(words, other.words, word_count);
+		}
+
+		size_t diff(const bitset_t& other, bitset_t& result) const
+		{
+			return diff_bits(words, other.words, result.words, word_count);
+		}
+
+		u64_t* get_words()
+		{
+			return words;
+		}
+
+		const u64_t* get_words() const
+		{
+			return words;
+		}
+
+	private:
+
+		u64_t words[word_count];
+	};
+
+	// Bits past the size are kept clear, so bitsets of the same size can be combined word by word
+	template<typename allocator_t = mem_allocator_t>
+	class dynamic_bitset_t
+	{
+	public:
+
+		dynamic_bitset_t(const dynamic_bitset_t&) = delete;
+		dynamic_bitset_t& operator = (const dynamic_bitset_t&) = delete;
+
+		explicit dynamic_bitset_t(const allocator_t& allocator_ = allocator_t()) : allocator(allocator_)
+		{
+			words = nullptr;
+			bit_count = 0;
+			word_count = 0;
+			capacity = 0;
+		}
+
+		~dynamic_bitset_t()
+		{
+			if (words != nullptr)
+			{
+				allocator.free(words);
+			}
+		}
+
+		// New bits start cleared
+		void resize(size_t new_bit_count)
+		{
+			size_t new_word_count = get_bit_word_count(new_bit_count);
+
+			if (new_word_count > capacity)
+			{
+				size_t new_capacity = max_of<size_t>(max_of<size_t>(capacity * 2, 8), new_word_count);
+				u64_t* new_words = (u64_t*)allocator.alloc(sizeof(u64_t) * new_capacity);
+
+				if (words != nullptr)
+				{
+					copy_mem(words, new_words, sizeof(u64_t) * word_count);
+					allocator.free(words);
+				}
+
+				words = new_words;
+				capacity = new_capacity;
+			}
+
+			if (new_word_count > word_count)
+			{
+				zero_mem(words + word_count, sizeof(u64_t) * (new_word_count - word_count));
+			}
+
+			bit_count = new_bit_count;
+			word_count = new_word_count;
+			clear_tail();
+		}
+
+		size_t get_size() const
+		{
+			return bit_count;
+		}
+
+		bool test_bit(size_t index) const
+		{
+			AUX_DEBUG_ASSERT(index < bit_count);
+
+			return (words[index / 64] & ((u64_t)1 << (index % 64))) != 0;
+		}
+
+		void set_bit(size_t index)
+		{
+			AUX_DEBUG_ASSERT(index < bit_count);
+
+			words[index / 64] |= (u64_t)1 << (index % 64);
+		}
+
+		void clear_bit(size_t index)
+		{
+			AUX_DEBUG_ASSERT(index < bit_count);
+
+			words[index / 64] &= ~((u64_t)1 << (index % 64));
+		}
+
+		void assign_bit(size_t index, bool value)
+		{
+			if (value)
+			{
+				set_bit(index);
+			}
+			else
+			{
+				clear_bit(index);
+			}
+		}
+
+		void set_all()
+		{
+			if (word_count > 0)
+			{
+				fill_mem(words, 0xff, sizeof(u64_t) * word_count);
+				clear_tail();
+			}
+		}
+
+		void clear()
+		{
+			if (word_count > 0)
+			{
+				zero_mem(words, sizeof(u64_t) * word_count);
+			}
+		}
+
+		size_t get_count() const
+		{
+			return count_bits(words, word_count);
+		}
+
+		bool is_empty() const
+		{
+			return find_next_bit(words, word_count, 0) == invalid_bit_index;
+		}
+
+		size_t find_first() const
+		{
+			return find_next_bit(words, word_count, 0);
+		}
+
+		size_t find_next(size_t pos) const
+		{
+			return (pos < bit_count) ? find_next_bit(words, word_count, pos) : invalid_bit_index;
+		}
+
+		template<typename func_t>
+		void for_each(func_t func) const
+		{
+			for_each_bit(words, word_count, func);
+		}
+
+		void and_with(const dynamic_bitset_t& other)
+		{
+			AUX_DEBUG_ASSERT(bit_count == other.bit_count);
+
+			and_bits(words, other.words, word_count);
+		}
+
+		void or_with(const dynamic_bitset_t& other)
+		{
+			AUX_DEBUG_ASSERT(bit_count == other.bit_count);
+
+			or_bits(words, other.words, word_count);
+		}
+
+		void xor_with(const dynamic_bitset_t& other)
+		{
+			AUX_DEBUG_ASSERT(bit_count == other.bit_count);
+
+			xor_bits(words, other.words, word_count);
+		}
+
+		void and_not_with(const dynamic_bitset_t& other)
+		{
+			AUX_DEBUG_ASSERT(bit_count == other.bit_count);
+
+			and_not_bits(words, other.words, word_count);
+		}
+
+		// The result is resized to match
+		size_t diff(const dynamic_bitset_t& other, dynamic_bitset_t& result) const
+		{
+			AUX_DEBUG_ASSERT(bit_count == other.bit_count);
+
+			result.resize(bit_count);
+			return diff_bits(words, other.words, result.words, word_count);
+		}
+
+		u64_t* get_words()
+		{
+			return words;
+		}
+
+		const u64_t* get_words() const
+		{
+			return words;
+		}
+
+		size_t get_word_count() const
+		{
+			return word_count;
+		}
+
+	private:
+
+		u64_t* words;
+		size_t bit_count;
+		size_t word_count;
+		size_t capacity;
+		allocator_t allocator;
+
+		void clear_tail()
+		{
+			if (bit_count % 64 != 0)
+			{
+				words[word_count - 1] &= ((u64_t)1 << (bit_count % 64)) - 1;
+			}
+		}
+	};
+}
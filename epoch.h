@@ -0,0 +1,34 @@
+#pragma once
+
+#include "base.h"
+
+namespace aux
+{
+	typedef void(*retire_handler_t)(void* mem);
+
+	// Shared memory may only be read between enter_epoch and exit_epoch, calls can be nested
+	void enter_epoch();
+	void exit_epoch();
+
+	// Memory is released once every thread has left the epoch it was retired in, free_mem is used without a handler
+	void retire_mem(void* mem, retire_handler_t handler = nullptr);
+	void flush_retired_mem();
+
+	class epoch_scope_t
+	{
+	public:
+
+		epoch_scope_t(const epoch_scope_t&) = delete;
+		epoch_scope_t& operator = (const epoch_scope_t&) = delete;
+
+		epoch_scope_t()
+		{
+			enter_epoch();
+		}
+
+		~epoch_scope_t()
+		{
+			exit_epoch();
+		}
+	};
+}
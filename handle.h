@@ -0,0 +1,205 @@
+#pragma once
+
+#include "base.h"
+
+namespace aux
+{
+	// Generation 0 is never issued, so a zeroed handle is always invalid
+	struct handle_t
+	{
+		u32_t index;
+		u32_t generation;
+	};
+
+	inline bool operator == (handle_t lhs, handle_t rhs)
+	{
+		return (lhs.index == rhs.index) && (lhs.generation == rhs.generation);
+	}
+
+	inline bool operator != (handle_t lhs, handle_t rhs)
+	{
+		return !(lhs == rhs);
+	}
+
+	// Values are kept densely packed and relocated with copy_mem, so T must be trivially relocatable
+	template<typename T>
+	class handle_table_t
+	{
+	public:
+
+		handle_table_t(const handle_table_t&) = delete;
+		handle_table_t& operator = (const handle_table_t&) = delete;
+
+		explicit handle_table_t(e32_t tag_ = MEM_TAG_GENERAL)
+		{
+			values = nullptr;
+			dense_slots = nullptr;
+			generations = nullptr;
+			slot_links = nullptr;
+			count = 0;
+			slot_count = 0;
+			capacity = 0;
+			free_head = UINT32_MAX;
+			tag = tag_;
+		}
+
+		~handle_table_t()
+		{
+			if (capacity > 0)
+			{
+				free_mem(values);
+				free_mem(dense_slots);
+				free_mem(generations);
+				free_mem(slot_links);
+			}
+		}
+
+		handle_t add(const T& value)
+		{
+			u32_t slot;
+
+			if (free_head != UINT32_MAX)
+			{
+				slot = free_head;
+				free_head = slot_links[slot];
+			}
+			else
+			{
+				if (slot_count == capacity)
+				{
+					grow();
+				}
+
+				slot = slot_count++;
+				generations[slot] = 1;
+			}
+
+			u32_t dense = count++;
+			values[dense] = value;
+			dense_slots[dense] = slot;
+			slot_links[slot] = dense;
+
+			handle_t handle;
+			handle.index = slot;
+			handle.generation = generations[slot];
+			return handle;
+		}
+
+		bool remove(handle_t handle)
+		{
+			if (!is_valid(handle))
+			{
+				return false;
+			}
+
+			// Swap the last value into the hole to keep the dense range packed
+			u32_t dense = slot_links[handle.index];
+			u32_t last = --count;
+
+			if (dense != last)
+			{
+				values[dense] = values[last];
+				dense_slots[dense] = dense_slots[last];
+				slot_links[dense_slots[dense]] = dense;
+			}
+
+			u32_t& generation = generations[handle.index];
+			generation = (generation == UINT32_MAX) ? 1 : generation + 1;
+			slot_links[handle.index] = free_head;
+			free_head = handle.index;
+			return true;
+		}
+
+		void clear()
+		{
+			for (u32_t i = 0; i < count; ++i)
+			{
+				u32_t slot = dense_slots[i];
+				u32_t& generation = generations[slot];
+				generation = (generation == UINT32_MAX) ? 1 : generation + 1;
+				slot_links[slot] = free_head;
+				free_head = slot;
+			}
+
+			count = 0;
+		}
+
+		bool is_valid(handle_t handle) const
+		{
+			return (handle.index < slot_count) && (generations[handle.index] == handle.generation);
+		}
+
+		T* find(handle_t handle)
+		{
+			return is_valid(handle) ? &values[slot_links[handle.index]] : nullptr;
+		}
+
+		const T* find(handle_t handle) const
+		{
+			return is_valid(handle) ? &values[slot_links[handle.index]] : nullptr;
+		}
+
+		u32_t get_count() const
+		{
+			return count;
+		}
+
+		T* get_values()
+		{
+			return values;
+		}
+
+		const T* get_values() const
+		{
+			return values;
+		}
+
+		handle_t get_handle(u32_t dense_index) const
+		{
+			AUX_DEBUG_ASSERT(dense_index < count);
+
+			handle_t handle;
+			handle.index = dense_slots[dense_index];
+			handle.generation = generations[handle.index];
+			return handle;
+		}
+
+	private:
+
+		T* values;
+		u32_t* dense_slots;
+		u32_t* generations;
+		u32_t* slot_links;
+		u32_t count;
+		u32_t slot_count;
+		u32_t capacity;
+		u32_t free_head;
+		e32_t tag;
+
+		template<typename U>
+		U* grow_array(U* items, u32_t new_capacity)
+		{
+			U* new_items = (U*)alloc_mem_tagged(sizeof(U) * new_capacity, tag);
+
+			if (items != nullptr)
+			{
+				copy_mem(items, new_items, sizeof(U) * capacity);
+				free_mem(items);
+			}
+
+			return new_items;
+		}
+
+		void grow()
+		{
+			AUX_DEBUG_ASSERT(capacity < UINT32_MAX / 2);
+
+			u32_t new_capacity = (capacity == 0) ? 16 : capacity * 2;
+			values = grow_array(values, new_capacity);
+			dense_slots = grow_array(dense_slots, new_capacity);
+			generations = grow_array(generations, new_capacity);
+			slot_links = grow_array(slot_links, new_capacity);
+			capacity = new_capacity;
+		}
+	};
+}
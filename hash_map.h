@@ -0,0 +1,467 @@
+#pragma once
+
+#include "base.h"
+
+#pragma warning(push, 0)
+
+#include <new>
+#include <string.h>
+#include <intrin.h>
+#include <emmintrin.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	inline u64_t mix_hash(u64_t value)
+	{
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccdull;
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53ull;
+		value ^= value >> 33;
+		return value;
+	}
+
+	inline u64_t hash_bytes(const void* data, size_t size, u64_t seed = 0)
+	{
+		const u8_t* bytes = (const u8_t*)data;
+		u64_t hash = seed ^ ((u64_t)size * 0x9e3779b97f4a7c15ull);
+
+		for (; size >= 8; size -= 8, bytes += 8)
+		{
+			u64_t word;
+			memcpy(&word, bytes, sizeof(word));
+			hash = (hash ^ word) * 0x9fb21c651e98df25ull;
+			hash ^= hash >> 29;
+		}
+
+		if (size > 0)
+		{
+			u64_t word = 0;
+			memcpy(&word, bytes, size);
+			hash = (hash ^ word) * 0x9fb21c651e98df25ull;
+		}
+
+		return mix_hash(hash);
+	}
+
+	inline u64_t get_hash_value(i32_t value)
+	{
+		return mix_hash((u64_t)(u32_t)value);
+	}
+
+	inline u64_t get_hash_value(u32_t value)
+	{
+		return mix_hash((u64_t)value);
+	}
+
+	inline u64_t get_hash_value(i64_t value)
+	{
+		return mix_hash((u64_t)value);
+	}
+
+	inline u64_t get_hash_value(u64_t value)
+	{
+		return mix_hash(value);
+	}
+
+	template<typename T>
+	inline u64_t get_hash_value(T* value)
+	{
+		return mix_hash((u64_t)(size_t)value);
+	}
+
+	template<typename T>
+	inline u64_t get_hash_value(const T& value)
+	{
+		return hash_bytes(&value, sizeof(T));
+	}
+
+	// Hash policies take any key type the map can be searched with, which makes lookups heterogeneous
+	struct default_hash_t
+	{
+		template<typename Q>
+		static u64_t get_hash(const Q& key)
+		{
+			return get_hash_value(key);
+		}
+
+		template<typename K, typename Q>
+		static bool is_equal(const K& lhs, const Q& rhs)
+		{
+			return lhs == rhs;
+		}
+	};
+
+	// Entries are relocated with copy_mem on rehash, so K and V must be trivially relocatable
+	template<typename K, typename V, typename hash_policy_t = default_hash_t, typename allocator_t = mem_allocator_t>
+	class hash_map_t
+	{
+	public:
+
+		static_assert((alignof(K) <= 16) && (alignof(V) <= 16), "hash_map_t entries can not be aligned above 16 bytes");
+
+		hash_map_t(const hash_map_t&) = delete;
+		hash_map_t& operator = (const hash_map_t&) = delete;
+
+		explicit hash_map_t(const allocator_t& allocator_ = allocator_t()) : allocator(allocator_)
+		{
+			ctrl = nullptr;
+			entries = nullptr;
+			count = 0;
+			capacity = 0;
+			growth_left = 0;
+		}
+
+		~hash_map_t()
+		{
+			if (capacity > 0)
+			{
+				destroy_entries();
+				allocator.free(ctrl);
+			}
+		}
+
+		size_t get_count() const
+		{
+			return count;
+		}
+
+		size_t get_capacity() const
+		{
+			return capacity;
+		}
+
+		template<typename Q>
+		V* find(const Q& key)
+		{
+			size_t index = find_index(key, hash_policy_t::get_hash(key));
+			return (index != invalid_index) ? &entries[index].value : nullptr;
+		}
+
+		template<typename Q>
+		const V* find(const Q& key) const
+		{
+			size_t index = find_index(key, hash_policy_t::get_hash(key));
+			return (index != invalid_index) ? &entries[index].value : nullptr;
+		}
+
+		template<typename Q>
+		bool contains(const Q& key) const
+		{
+			return find_index(key, hash_policy_t::get_hash(key)) != invalid_index;
+		}
+
+		// Inserting may rehash, which invalidates pointers into the map including the arguments
+		bool insert(const K& key, const V& value)
+		{
+			u64_t hash = hash_policy_t::get_hash(key);
+
+			if (find_index(key, hash) != invalid_index)
+			{
+				return false;
+			}
+
+			entry_t& entry = add_entry(hash);
+			new (&entry.key) K(key);
+			new (&entry.value) V(value);
+			return true;
+		}
+
+		V& set(const K& key, const V& value)
+		{
+			u64_t hash = hash_policy_t::get_hash(key);
+			size_t index = find_index(key, hash);
+
+			if (index != invalid_index)
+			{
+				entries[index].value = value;
+				return entries[index].value;
+			}
+
+			entry_t& entry = add_entry(hash);
+			new (&entry.key) K(key);
+			return *new (&entry.value) V(value);
+		}
+
+		V& get_or_add(const K& key)
+		{
+			u64_t hash = hash_policy_t::get_hash(key);
+			size_t index = find_index(key, hash);
+
+			if (index != invalid_index)
+			{
+				return entries[index].value;
+			}
+
+			entry_t& entry = add_entry(hash);
+			new (&entry.key) K(key);
+			return *new (&entry.value) V();
+		}
+
+		template<typename Q>
+		bool remove(const Q& key)
+		{
+			size_t index = find_index(key, hash_policy_t::get_hash(key));
+
+			if (index == invalid_index)
+			{
+				return false;
+			}
+
+			entries[index].key.~K();
+			entries[index].value.~V();
+			--count;
+
+			// Slots no probe could have passed over while full go back to empty instead of leaving a tombstone
+			size_t before = (index - group_width) & (capacity - 1);
+			u32_t empty_after = match_byte(ctrl + index, ctrl_empty);
+			u32_t empty_before = match_byte(ctrl + before, ctrl_empty);
+
+			if ((empty_after != 0) && (empty_before != 0) && (find_first_bit(empty_after) + (group_width - 1 - find_last_bit(empty_before)) < group_width))
+			{
+				set_ctrl(index, ctrl_empty);
+				++growth_left;
+			}
+			else
+			{
+				set_ctrl(index, ctrl_deleted);
+			}
+
+			return true;
+		}
+
+		void clear()
+		{
+			if (capacity > 0)
+			{
+				destroy_entries();
+				fill_mem(ctrl, (u8_t)ctrl_empty, capacity + group_width);
+				count = 0;
+				growth_left = get_max_count(capacity);
+			}
+		}
+
+		void reserve(size_t size)
+		{
+			if (size > count + growth_left)
+			{
+				rehash(get_capacity_for(size));
+			}
+		}
+
+		template<typename F>
+		void for_each(F func)
+		{
+			for (size_t i = 0; i < capacity; ++i)
+			{
+				if (ctrl[i] >= 0)
+				{
+					func(entries[i].key, entries[i].value);
+				}
+			}
+		}
+
+	private:
+
+		struct entry_t
+		{
+			K key;
+			V value;
+		};
+
+		static const size_t group_width = 16;
+		static const size_t min_capacity = 16;
+		static const size_t invalid_index = SIZE_MAX;
+		static const i8_t ctrl_empty = -128;
+		static const i8_t ctrl_deleted = -2;
+
+		i8_t* ctrl;
+		entry_t* entries;
+		size_t count;
+		size_t capacity;
+		size_t growth_left;
+		allocator_t allocator;
+
+		static u32_t match_byte(const i8_t* group, i8_t value)
+		{
+			__m128i bytes = _mm_loadu_si128((const __m128i*)group);
+			return (u32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value)));
+		}
+
+		// Empty and deleted bytes are the only ones with the sign bit set
+		static u32_t match_free(const i8_t* group)
+		{
+			return (u32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+		}
+
+		static u32_t find_first_bit(u32_t mask)
+		{
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return (u32_t)index;
+		}
+
+		static u32_t find_last_bit(u32_t mask)
+		{
+			unsigned long index;
+			_BitScanReverse(&index, mask);
+			return (u32_t)index;
+		}
+
+		static i8_t get_h2(u64_t hash)
+		{
+			return (i8_t)(hash & 0x7f);
+		}
+
+		static size_t get_max_count(size_t size)
+		{
+			return size - size / 8;
+		}
+
+		static size_t get_capacity_for(size_t size)
+		{
+			size_t new_capacity = min_capacity;
+
+			while (get_max_count(new_capacity) < size)
+			{
+				new_capacity *= 2;
+			}
+
+			return new_capacity;
+		}
+
+		// The first group is mirrored past the end so groups can be loaded at any slot
+		void set_ctrl(size_t index, i8_t value)
+		{
+			ctrl[index] = value;
+
+			if (index < group_width)
+			{
+				ctrl[capacity + index] = value;
+			}
+		}
+
+		template<typename Q>
+		size_t find_index(const Q& key, u64_t hash) const
+		{
+			if (capacity == 0)
+			{
+				return invalid_index;
+			}
+
+			size_t mask = capacity - 1;
+			size_t pos = (size_t)(hash >> 7) & mask;
+			i8_t h2 = get_h2(hash);
+
+			for (size_t step = group_width;; step += group_width)
+			{
+				const i8_t* group = ctrl + pos;
+
+				for (u32_t matches = match_byte(group, h2); matches != 0; matches &= matches - 1)
+				{
+					size_t index = (pos + find_first_bit(matches)) & mask;
+
+					if (hash_policy_t::is_equal(entries[index].key, key))
+					{
+						return index;
+					}
+				}
+
+				if (match_byte(group, ctrl_empty) != 0)
+				{
+					return invalid_index;
+				}
+
+				pos = (pos + step) & mask;
+			}
+		}
+
+		size_t find_free(u64_t hash) const
+		{
+			size_t mask = capacity - 1;
+			size_t pos = (size_t)(hash >> 7) & mask;
+
+			for (size_t step = group_width;; step += group_width)
+			{
+				u32_t matches = match_free(ctrl + pos);
+
+				if (matches != 0)
+				{
+					return (pos + find_first_bit(matches)) & mask;
+				}
+
+				pos = (pos + step) & mask;
+			}
+		}
+
+		entry_t& add_entry(u64_t hash)
+		{
+			if (capacity == 0)
+			{
+				rehash(min_capacity);
+			}
+
+			size_t index = find_free(hash);
+
+			// Reusing a tombstone needs no growth, otherwise a full table is rehashed first
+			if ((growth_left == 0) && (ctrl[index] != ctrl_deleted))
+			{
+				rehash(get_capacity_for(count + 1));
+				index = find_free(hash);
+			}
+
+			if (ctrl[index] == ctrl_empty)
+			{
+				--growth_left;
+			}
+
+			set_ctrl(index, get_h2(hash));
+			++count;
+			return entries[index];
+		}
+
+		void destroy_entries()
+		{
+			for (size_t i = 0; i < capacity; ++i)
+			{
+				if (ctrl[i] >= 0)
+				{
+					entries[i].key.~K();
+					entries[i].value.~V();
+				}
+			}
+		}
+
+		void rehash(size_t new_capacity)
+		{
+			i8_t* old_ctrl = ctrl;
+			entry_t* old_entries = entries;
+			size_t old_capacity = capacity;
+			size_t ctrl_size = (new_capacity + group_width + 15) & ~(size_t)15;
+			u8_t* block = (u8_t*)allocator.alloc(ctrl_size + sizeof(entry_t) * new_capacity);
+			ctrl = (i8_t*)block;
+			entries = (entry_t*)(block + ctrl_size);
+			capacity = new_capacity;
+			growth_left = get_max_count(new_capacity) - count;
+			fill_mem(ctrl, (u8_t)ctrl_empty, new_capacity + group_width);
+
+			for (size_t i = 0; i < old_capacity; ++i)
+			{
+				if (old_ctrl[i] >= 0)
+				{
+					u64_t hash = hash_policy_t::get_hash(old_entries[i].key);
+					size_t index = find_free(hash);
+					set_ctrl(index, get_h2(hash));
+					copy_mem(&old_entries[i], &entries[index], sizeof(entry_t));
+				}
+			}
+
+			if (old_capacity > 0)
+			{
+				allocator.free(old_ctrl);
+			}
+		}
+	};
+}
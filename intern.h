@@ -0,0 +1,21 @@
+#pragma once
+
+#include "base.h"
+
+namespace aux
+{
+	const u32_t invalid_intern_id = 0;
+
+	// Ids start at 1 and, like the interned text, stay valid for the rest of the process
+	u32_t intern_string(const char str[]);
+	u32_t intern_string(const char str[], size_t length);
+	u32_t find_interned_string(const char str[]);
+	u32_t find_interned_string(const char str[], size_t length);
+
+	const char* get_interned_string(u32_t id);
+	size_t get_interned_length(u32_t id);
+	u32_t get_interned_count();
+
+	// Interns every non-empty line of a UTF-8 text file
+	bool load_interned_strings(const char path[]);
+}
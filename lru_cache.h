@@ -0,0 +1,460 @@
+#pragma once
+
+#include "hash_map.h"
+#include "thread.h"
+
+namespace aux
+{
+	struct lru_stats_t
+	{
+		u64_t hit_count;
+		u64_t miss_count;
+		u64_t eviction_count;
+		size_t used_bytes;
+		size_t budget_bytes;
+		size_t entry_count;
+	};
+
+	// Entries are evicted from the cold end once the summed cost passes the budget, pinned entries are skipped
+	template<typename K, typename V, typename hash_policy_t = default_hash_t>
+	class lru_cache_t
+	{
+	public:
+
+		typedef void(*evict_handler_t)(const K& key, V& value, void* user_ptr);
+
+		lru_cache_t(const lru_cache_t&) = delete;
+		lru_cache_t& operator = (const lru_cache_t&) = delete;
+
+		explicit lru_cache_t(size_t budget_, e32_t tag_ = MEM_TAG_GENERAL) : entries(mem_allocator_t(tag_))
+		{
+			head = nullptr;
+			tail = nullptr;
+			evict_handler = nullptr;
+			evict_user_ptr = nullptr;
+			used = 0;
+			budget = budget_;
+			hit_count = 0;
+			miss_count = 0;
+			eviction_count = 0;
+			tag = tag_;
+			updating = false;
+		}
+
+		~lru_cache_t()
+		{
+			clear();
+		}
+
+		void set_evict_handler(evict_handler_t handler, void* user_ptr)
+		{
+			evict_handler = handler;
+			evict_user_ptr = user_ptr;
+		}
+
+		// Finding an entry makes it the most recently used one
+		V* find(const K& key)
+		{
+			entry_t** entry = entries.find(key);
+
+			if (entry == nullptr)
+			{
+				++miss_count;
+				return nullptr;
+			}
+
+			++hit_count;
+			touch(*entry);
+			return &(*entry)->value;
+		}
+
+		// Entries never move in memory, so the returned pointer stays valid until the entry is evicted or removed
+		V* insert(const K& key, const V& value, size_t cost)
+		{
+			// Allocations below may reclaim, which must not evict from the cache while it is being changed
+			updating = true;
+			entry_t** found = entries.find(key);
+			entry_t* entry;
+
+			if (found != nullptr)
+			{
+				entry = *found;
+				++entry->pin_count;
+				entry->value = value;
+				used = used - entry->cost + cost;
+				entry->cost = cost;
+				touch(entry);
+			}
+			else
+			{
+				entry = (entry_t*)alloc_mem_tagged(sizeof(entry_t), tag);
+				new (&entry->key) K(key);
+				new (&entry->value) V(value);
+				entry->cost = cost;
+				entry->pin_count = 1;
+				entries.insert(key, entry);
+				link_front(entry);
+				used += cost;
+			}
+
+			evict_to(budget);
+			updating = false;
+			--entry->pin_count;
+			return &entry->value;
+		}
+
+		bool remove(const K& key)
+		{
+			entry_t** found = entries.find(key);
+
+			if (found == nullptr)
+			{
+				return false;
+			}
+
+			destroy_entry(*found, false);
+			return true;
+		}
+
+		V* pin(const K& key)
+		{
+			entry_t** entry = entries.find(key);
+
+			if (entry == nullptr)
+			{
+				++miss_count;
+				return nullptr;
+			}
+
+			++hit_count;
+			++(*entry)->pin_count;
+			touch(*entry);
+			return &(*entry)->value;
+		}
+
+		void unpin(const K& key)
+		{
+			entry_t** entry = entries.find(key);
+			AUX_DEBUG_ASSERT((entry != nullptr) && ((*entry)->pin_count > 0));
+
+			--(*entry)->pin_count;
+		}
+
+		void set_budget(size_t size)
+		{
+			budget = size;
+			evict_to(budget);
+		}
+
+		// Evicts at least size bytes when enough unpinned entries exist and returns the bytes released
+		size_t evict(size_t size)
+		{
+			size_t prev_used = used;
+			evict_to((size < used) ? used - size : 0);
+			return prev_used - used;
+		}
+
+		void clear()
+		{
+			while (head != nullptr)
+			{
+				destroy_entry(head, false);
+			}
+		}
+
+		void get_stats(lru_stats_t& stats) const
+		{
+			stats.hit_count = hit_count;
+			stats.miss_count = miss_count;
+			stats.eviction_count = eviction_count;
+			stats.used_bytes = used;
+			stats.budget_bytes = budget;
+			stats.entry_count = entries.get_count();
+		}
+
+		// Matches mem_reclaim_handler_t, reclaim runs on any allocating thread, so only register a cache used by a single thread
+		static size_t on_reclaim(size_t size, void* user_ptr)
+		{
+			lru_cache_t* cache = (lru_cache_t*)user_ptr;
+			return cache->updating ? 0 : cache->evict(size);
+		}
+
+	private:
+
+		struct entry_t
+		{
+			entry_t* prev;
+			entry_t* next;
+			K key;
+			V value;
+			size_t cost;
+			u32_t pin_count;
+		};
+
+		hash_map_t<K, entry_t*, hash_policy_t> entries;
+		entry_t* head;
+		entry_t* tail;
+		evict_handler_t evict_handler;
+		void* evict_user_ptr;
+		size_t used;
+		size_t budget;
+		u64_t hit_count;
+		u64_t miss_count;
+		u64_t eviction_count;
+		e32_t tag;
+		bool updating;
+
+		void link_front(entry_t* entry)
+		{
+			entry->prev = nullptr;
+			entry->next = head;
+
+			if (head != nullptr)
+			{
+				head->prev = entry;
+			}
+			else
+			{
+				tail = entry;
+			}
+
+			head = entry;
+		}
+
+		void unlink(entry_t* entry)
+		{
+			if (entry->prev != nullptr)
+			{
+				entry->prev->next = entry->next;
+			}
+			else
+			{
+				head = entry->next;
+			}
+
+			if (entry->next != nullptr)
+			{
+				entry->next->prev = entry->prev;
+			}
+			else
+			{
+				tail = entry->prev;
+			}
+		}
+
+		void touch(entry_t* entry)
+		{
+			if (entry != head)
+			{
+				unlink(entry);
+				link_front(entry);
+			}
+		}
+
+		// The entry is detached before the handler runs, so nothing the handler triggers can reach it again
+		void destroy_entry(entry_t* entry, bool evicted)
+		{
+			unlink(entry);
+			entries.remove(entry->key);
+			used -= entry->cost;
+
+			if (evicted)
+			{
+				if (evict_handler != nullptr)
+				{
+					evict_handler(entry->key, entry->value, evict_user_ptr);
+				}
+
+				++eviction_count;
+			}
+
+			entry->key.~K();
+			entry->value.~V();
+			free_mem(entry);
+		}
+
+		// Eviction handlers may allocate, and a reclaim started by that must not evict from under this loop
+		void evict_to(size_t size)
+		{
+			bool was_updating = updating;
+			updating = true;
+			entry_t* entry = tail;
+
+			while ((used > size) && (entry != nullptr))
+			{
+				entry_t* prev = entry->prev;
+
+				if (entry->pin_count == 0)
+				{
+					destroy_entry(entry, true);
+				}
+
+				entry = prev;
+			}
+
+			updating = was_updating;
+		}
+	};
+
+	// Keys are spread over independently locked caches, each holding an equal share of the budget
+	template<typename K, typename V, u32_t shard_count = 16, typename hash_policy_t = default_hash_t>
+	class sharded_lru_cache_t
+	{
+	public:
+
+		typedef typename lru_cache_t<K, V, hash_policy_t>::evict_handler_t evict_handler_t;
+
+		sharded_lru_cache_t(const sharded_lru_cache_t&) = delete;
+		sharded_lru_cache_t& operator = (const sharded_lru_cache_t&) = delete;
+
+		explicit sharded_lru_cache_t(size_t budget, e32_t tag = MEM_TAG_GENERAL)
+		{
+			for (u32_t i = 0; i < shard_count; ++i)
+			{
+				shards[i].lock.state = nullptr;
+				shards[i].cache = new (alloc_mem_tagged(sizeof(cache_t), tag)) cache_t(budget / shard_count, tag);
+			}
+		}
+
+		~sharded_lru_cache_t()
+		{
+			for (u32_t i = 0; i < shard_count; ++i)
+			{
+				shards[i].cache->~cache_t();
+				free_mem(shards[i].cache);
+			}
+		}
+
+		// The handler runs with the shard locked and must not call back into the cache
+		void set_evict_handler(evict_handler_t handler, void* user_ptr)
+		{
+			for (u32_t i = 0; i < shard_count; ++i)
+			{
+				lock_scope_t scope(shards[i].lock);
+				shards[i].cache->set_evict_handler(handler, user_ptr);
+			}
+		}
+
+		bool find(const K& key, V& value)
+		{
+			shard_t& shard = get_shard(key);
+			lock_scope_t scope(shard.lock);
+			const V* found = shard.cache->find(key);
+
+			if (found == nullptr)
+			{
+				return false;
+			}
+
+			value = *found;
+			return true;
+		}
+
+		void insert(const K& key, const V& value, size_t cost)
+		{
+			shard_t& shard = get_shard(key);
+			lock_scope_t scope(shard.lock);
+			shard.cache->insert(key, value, cost);
+		}
+
+		bool remove(const K& key)
+		{
+			shard_t& shard = get_shard(key);
+			lock_scope_t scope(shard.lock);
+			return shard.cache->remove(key);
+		}
+
+		// A pinned value stays in place until unpinned, as long as no other thread replaces or removes its key
+		V* pin(const K& key)
+		{
+			shard_t& shard = get_shard(key);
+			lock_scope_t scope(shard.lock);
+			return shard.cache->pin(key);
+		}
+
+		void unpin(const K& key)
+		{
+			shard_t& shard = get_shard(key);
+			lock_scope_t scope(shard.lock);
+			shard.cache->unpin(key);
+		}
+
+		void set_budget(size_t size)
+		{
+			for (u32_t i = 0; i < shard_count; ++i)
+			{
+				lock_scope_t scope(shards[i].lock);
+				shards[i].cache->set_budget(size / shard_count);
+			}
+		}
+
+		size_t evict(size_t size)
+		{
+			return evict_shards(size, true);
+		}
+
+		void get_stats(lru_stats_t& stats)
+		{
+			zero_mem(&stats, sizeof(stats));
+
+			for (u32_t i = 0; i < shard_count; ++i)
+			{
+				lru_stats_t shard_stats;
+				lock_scope_t scope(shards[i].lock);
+				shards[i].cache->get_stats(shard_stats);
+				stats.hit_count += shard_stats.hit_count;
+				stats.miss_count += shard_stats.miss_count;
+				stats.eviction_count += shard_stats.eviction_count;
+				stats.used_bytes += shard_stats.used_bytes;
+				stats.budget_bytes += shard_stats.budget_bytes;
+				stats.entry_count += shard_stats.entry_count;
+			}
+		}
+
+		// Busy shards are skipped, the allocating thread may be the one holding their lock
+		static size_t on_reclaim(size_t size, void* user_ptr)
+		{
+			return ((sharded_lru_cache_t*)user_ptr)->evict_shards(size, false);
+		}
+
+	private:
+
+		typedef lru_cache_t<K, V, hash_policy_t> cache_t;
+
+		struct alignas(cache_line_size) shard_t
+		{
+			lock_t lock;
+			cache_t* cache;
+		};
+
+		shard_t shards[shard_count];
+
+		// The map probes with the low hash bits, so shards are picked with the high ones
+		shard_t& get_shard(const K& key)
+		{
+			return shards[(u32_t)(hash_policy_t::get_hash(key) >> 40) % shard_count];
+		}
+
+		size_t evict_shards(size_t size, bool wait)
+		{
+			size_t evicted = 0;
+
+			for (u32_t i = 0; (i < shard_count) && (evicted < size); ++i)
+			{
+				if (wait)
+				{
+					acquire_lock(shards[i].lock);
+				}
+				else if (!try_acquire_lock(shards[i].lock))
+				{
+					continue;
+				}
+
+				evicted += shards[i].cache->evict((size - evicted + shard_count - 1 - i) / (shard_count - i));
+				release_lock(shards[i].lock);
+			}
+
+			return evicted;
+		}
+	};
+}
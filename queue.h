@@ -0,0 +1,494 @@
+#pragma once
+
+#include "thread.h"
+
+#pragma warning(push, 0)
+
+#include <type_traits>
+#include <intrin.h>
+#include <emmintrin.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	// Blocking push and pop are only available when the queue is built with blocking set,
+	// since waking a sleeper costs a full fence on every operation
+	template<typename T, bool blocking = false>
+	class spsc_queue_t
+	{
+	public:
+
+		static_assert(std::is_trivially_copyable<T>::value, "spsc_queue_t items must be trivially copyable");
+
+		spsc_queue_t(const spsc_queue_t&) = delete;
+		spsc_queue_t& operator = (const spsc_queue_t&) = delete;
+
+		explicit spsc_queue_t(u32_t capacity, e32_t tag = MEM_TAG_GENERAL)
+		{
+			AUX_DEBUG_ASSERT((capacity > 0) && (capacity <= 0x80000000u));
+
+			u32_t size = 1;
+
+			while (size < capacity)
+			{
+				size *= 2;
+			}
+
+			items = (T*)alloc_mem_aligned(sizeof(T) * size, cache_line_size, tag);
+			mask = size - 1;
+			head = 0;
+			tail = 0;
+			cached_head = 0;
+			cached_tail = 0;
+			producer_waiting = 0;
+			consumer_waiting = 0;
+		}
+
+		~spsc_queue_t()
+		{
+			free_mem_aligned(items);
+		}
+
+		u32_t get_capacity() const
+		{
+			return mask + 1;
+		}
+
+		bool try_push(const T& item)
+		{
+			return push_many(&item, 1) == 1;
+		}
+
+		bool try_pop(T& item)
+		{
+			return pop_many(&item, 1) == 1;
+		}
+
+		// Each side keeps a cached copy of the other side's position and only reloads it when the cache runs dry
+		u32_t push_many(const T* src, u32_t count)
+		{
+			u32_t pos = tail;
+			u32_t free_count = mask + 1 - (pos - cached_head);
+
+			if (free_count < count)
+			{
+				cached_head = head;
+				free_count = mask + 1 - (pos - cached_head);
+			}
+
+			count = min_of(count, free_count);
+
+			for (u32_t i = 0; i < count; ++i)
+			{
+				items[(pos + i) & mask] = src[i];
+			}
+
+			if (count > 0)
+			{
+				tail = pos + count;
+				notify(tail, consumer_waiting);
+			}
+
+			return count;
+		}
+
+		u32_t pop_many(T* dst, u32_t count)
+		{
+			u32_t pos = head;
+			u32_t used_count = cached_tail - pos;
+
+			if (used_count < count)
+			{
+				cached_tail = tail;
+				used_count = cached_tail - pos;
+			}
+
+			count = min_of(count, used_count);
+
+			for (u32_t i = 0; i < count; ++i)
+			{
+				dst[i] = items[(pos + i) & mask];
+			}
+
+			if (count > 0)
+			{
+				head = pos + count;
+				notify(head, producer_waiting);
+			}
+
+			return count;
+		}
+
+		void push(const T& item)
+		{
+			static_assert(blocking, "Blocking push needs a queue created with blocking set");
+
+			while (!try_push(item))
+			{
+				u32_t pos = head;
+				_InterlockedExchange((volatile long*)&producer_waiting, 1);
+
+				if (tail - head > mask)
+				{
+					wait_on_value(&head, pos);
+				}
+
+				producer_waiting = 0;
+			}
+		}
+
+		void pop(T& item)
+		{
+			static_assert(blocking, "Blocking pop needs a queue created with blocking set");
+
+			while (!try_pop(item))
+			{
+				u32_t pos = tail;
+				_InterlockedExchange((volatile long*)&consumer_waiting, 1);
+
+				if (tail == head)
+				{
+					wait_on_value(&tail, pos);
+				}
+
+				consumer_waiting = 0;
+			}
+		}
+
+	private:
+
+		alignas(cache_line_size) volatile u32_t head;
+		u32_t cached_tail;
+		volatile u32_t producer_waiting;
+		alignas(cache_line_size) volatile u32_t tail;
+		u32_t cached_head;
+		volatile u32_t consumer_waiting;
+		alignas(cache_line_size) T* items;
+		u32_t mask;
+
+		// Volatile stores only release, so the position store needs a full fence before the waiting flag is read
+		void notify(volatile u32_t& position, volatile u32_t& waiting)
+		{
+			if (blocking)
+			{
+				_mm_mfence();
+
+				if (waiting != 0)
+				{
+					wake_single_waiter(&position);
+				}
+			}
+		}
+	};
+
+	// Every cell carries a sequence number telling which lap it is ready for, so producers and consumers
+	// only contend on their own position and never on each other
+	template<typename T, bool blocking = false>
+	class mpmc_queue_t
+	{
+	public:
+
+		static_assert(std::is_trivially_copyable<T>::value, "mpmc_queue_t items must be trivially copyable");
+
+		mpmc_queue_t(const mpmc_queue_t&) = delete;
+		mpmc_queue_t& operator = (const mpmc_queue_t&) = delete;
+
+		explicit mpmc_queue_t(u32_t capacity, e32_t tag = MEM_TAG_GENERAL)
+		{
+			AUX_DEBUG_ASSERT((capacity > 1) && (capacity <= 0x40000000u));
+
+			u32_t size = 2;
+
+			while (size < capacity)
+			{
+				size *= 2;
+			}
+
+			cells = (cell_t*)alloc_mem_aligned(sizeof(cell_t) * size, cache_line_size, tag);
+			mask = size - 1;
+
+			for (u32_t i = 0; i < size; ++i)
+			{
+				cells[i].sequence = i;
+			}
+
+			enqueue_pos = 0;
+			dequeue_pos = 0;
+			push_event = 0;
+			pop_event = 0;
+			push_waiters = 0;
+			pop_waiters = 0;
+		}
+
+		~mpmc_queue_t()
+		{
+			free_mem_aligned(cells);
+		}
+
+		u32_t get_capacity() const
+		{
+			return mask + 1;
+		}
+
+		bool try_push(const T& item)
+		{
+			u32_t pos = enqueue_pos;
+			cell_t* cell;
+
+			for (;;)
+			{
+				cell = &cells[pos & mask];
+				i32_t diff = (i32_t)(cell->sequence - pos);
+
+				if (diff == 0)
+				{
+					u32_t seen = (u32_t)_InterlockedCompareExchange((volatile long*)&enqueue_pos, (long)(pos + 1), (long)pos);
+
+					if (seen == pos)
+					{
+						break;
+					}
+
+					pos = seen;
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = enqueue_pos;
+				}
+			}
+
+			cell->item = item;
+			cell->sequence = pos + 1;
+			notify(push_event, pop_waiters, 1);
+			return true;
+		}
+
+		bool try_pop(T& item)
+		{
+			u32_t pos = dequeue_pos;
+			cell_t* cell;
+
+			for (;;)
+			{
+				cell = &cells[pos & mask];
+				i32_t diff = (i32_t)(cell->sequence - (pos + 1));
+
+				if (diff == 0)
+				{
+					u32_t seen = (u32_t)_InterlockedCompareExchange((volatile long*)&dequeue_pos, (long)(pos + 1), (long)pos);
+
+					if (seen == pos)
+					{
+						break;
+					}
+
+					pos = seen;
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = dequeue_pos;
+				}
+			}
+
+			item = cell->item;
+			cell->sequence = pos + mask + 1;
+			notify(pop_event, push_waiters, 1);
+			return true;
+		}
+
+		// Batches claim a whole range with one exchange and then wait for each cell to be handed over
+		u32_t push_many(const T* src, u32_t count)
+		{
+			u32_t pos = enqueue_pos;
+			u32_t claimed;
+
+			for (;;)
+			{
+				i32_t used_count = (i32_t)(pos - dequeue_pos);
+
+				if (used_count < 0)
+				{
+					pos = enqueue_pos;
+					continue;
+				}
+
+				claimed = min_of(count, mask + 1 - min_of((u32_t)used_count, mask + 1));
+
+				if (claimed == 0)
+				{
+					return 0;
+				}
+
+				u32_t seen = (u32_t)_InterlockedCompareExchange((volatile long*)&enqueue_pos, (long)(pos + claimed), (long)pos);
+
+				if (seen == pos)
+				{
+					break;
+				}
+
+				pos = seen;
+			}
+
+			for (u32_t i = 0; i < claimed; ++i)
+			{
+				cell_t& cell = cells[(pos + i) & mask];
+				wait_for_sequence(cell, pos + i);
+				cell.item = src[i];
+				cell.sequence = pos + i + 1;
+			}
+
+			notify(push_event, pop_waiters, claimed);
+			return claimed;
+		}
+
+		u32_t pop_many(T* dst, u32_t count)
+		{
+			u32_t pos = dequeue_pos;
+			u32_t claimed;
+
+			for (;;)
+			{
+				i32_t used_count = (i32_t)(enqueue_pos - pos);
+
+				if (used_count <= 0)
+				{
+					return 0;
+				}
+
+				claimed = min_of(count, (u32_t)used_count);
+
+				u32_t seen = (u32_t)_InterlockedCompareExchange((volatile long*)&dequeue_pos, (long)(pos + claimed), (long)pos);
+
+				if (seen == pos)
+				{
+					break;
+				}
+
+				pos = seen;
+			}
+
+			for (u32_t i = 0; i < claimed; ++i)
+			{
+				cell_t& cell = cells[(pos + i) & mask];
+				wait_for_sequence(cell, pos + i + 1);
+				dst[i] = cell.item;
+				cell.sequence = pos + i + mask + 1;
+			}
+
+			notify(pop_event, push_waiters, claimed);
+			return claimed;
+		}
+
+		void push(const T& item)
+		{
+			static_assert(blocking, "Blocking push needs a queue created with blocking set");
+
+			for (;;)
+			{
+				u32_t event = pop_event;
+
+				if (try_push(item))
+				{
+					return;
+				}
+
+				wait(pop_event, push_waiters, event);
+			}
+		}
+
+		void pop(T& item)
+		{
+			static_assert(blocking, "Blocking pop needs a queue created with blocking set");
+
+			for (;;)
+			{
+				u32_t event = push_event;
+
+				if (try_pop(item))
+				{
+					return;
+				}
+
+				wait(push_event, pop_waiters, event);
+			}
+		}
+
+	private:
+
+		struct cell_t
+		{
+			volatile u32_t sequence;
+			T item;
+		};
+
+		static const u32_t max_spin_count = 256;
+
+		alignas(cache_line_size) volatile u32_t enqueue_pos;
+		alignas(cache_line_size) volatile u32_t dequeue_pos;
+		alignas(cache_line_size) volatile u32_t push_event;
+		volatile u32_t pop_waiters;
+		alignas(cache_line_size) volatile u32_t pop_event;
+		volatile u32_t push_waiters;
+		alignas(cache_line_size) cell_t* cells;
+		u32_t mask;
+
+		static void wait_for_sequence(const cell_t& cell, u32_t sequence)
+		{
+			// The owner of the cell may be preempted, so spinning backs off to sleeping
+			for (u32_t spin = 0; cell.sequence != sequence; ++spin)
+			{
+				if (spin < max_spin_count)
+				{
+					_mm_pause();
+				}
+				else
+				{
+					suspend_current_thread(0);
+				}
+			}
+		}
+
+		// Events only ever count up, value is read before the failed attempt, so any change made since then
+		// is seen after announcing the waiter and the sleep is skipped
+		void wait(volatile u32_t& event, volatile u32_t& waiters, u32_t value)
+		{
+			_InterlockedIncrement((volatile long*)&waiters);
+
+			if (event == value)
+			{
+				wait_on_value(&event, value);
+			}
+
+			_InterlockedDecrement((volatile long*)&waiters);
+		}
+
+		void notify(volatile u32_t& event, volatile u32_t& waiters, u32_t count)
+		{
+			if (blocking)
+			{
+				_InterlockedIncrement((volatile long*)&event);
+
+				if (waiters != 0)
+				{
+					if (count == 1)
+					{
+						wake_single_waiter(&event);
+					}
+					else
+					{
+						wake_all_waiters(&event);
+					}
+				}
+			}
+		}
+	};
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "base.h"
+
+namespace aux
+{
+	struct ring_buffer_t;
+
+	// Capacity is rounded up to a power of two no smaller than the allocation granularity
+	ring_buffer_t* create_ring_buffer(size_t capacity);
+	void destroy_ring_buffer(ring_buffer_t* ring);
+
+	size_t get_ring_buffer_capacity(const ring_buffer_t* ring);
+	size_t get_ring_buffer_size(const ring_buffer_t* ring);
+
+	void* begin_ring_buffer_write(ring_buffer_t* ring, size_t& size);
+	void end_ring_buffer_write(ring_buffer_t* ring, size_t size);
+	const void* begin_ring_buffer_read(ring_buffer_t* ring, size_t& size);
+	void end_ring_buffer_read(ring_buffer_t* ring, size_t size);
+
+	size_t write_ring_buffer(ring_buffer_t* ring, size_t size, const void* data);
+	size_t read_ring_buffer(ring_buffer_t* ring, size_t size, void* data);
+}
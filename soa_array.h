@@ -0,0 +1,282 @@
+#pragma once
+
+#include "base.h"
+
+#pragma warning(push, 0)
+
+#include <type_traits>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	template<size_t... indices>
+	struct index_list_t
+	{
+	};
+
+	template<size_t count, size_t... indices>
+	struct make_index_list_t : make_index_list_t<count - 1, count - 1, indices...>
+	{
+	};
+
+	template<size_t... indices>
+	struct make_index_list_t<0, indices...>
+	{
+		typedef index_list_t<indices...> type;
+	};
+
+	template<size_t index, typename T, typename... rest_t>
+	struct type_at_t
+	{
+		typedef typename type_at_t<index - 1, rest_t...>::type type;
+	};
+
+	template<typename T, typename... rest_t>
+	struct type_at_t<0, T, rest_t...>
+	{
+		typedef T type;
+	};
+
+	template<typename... types_t>
+	struct all_trivially_copyable_t : std::true_type
+	{
+	};
+
+	template<typename T, typename... rest_t>
+	struct all_trivially_copyable_t<T, rest_t...> : std::integral_constant<bool, std::is_trivially_copyable<T>::value && all_trivially_copyable_t<rest_t...>::value>
+	{
+	};
+
+	// Every field gets its own cache line aligned column, columns are moved with copy_mem so fields must be trivially copyable
+	template<typename... fields_t>
+	class soa_array_t
+	{
+		static_assert(all_trivially_copyable_t<fields_t...>::value, "soa_array_t fields must be trivially copyable");
+
+	public:
+
+		static const size_t field_count = sizeof...(fields_t);
+
+		template<size_t index>
+		using field_t = typename type_at_t<index, fields_t...>::type;
+
+		soa_array_t(const soa_array_t&) = delete;
+		soa_array_t& operator = (const soa_array_t&) = delete;
+
+		explicit soa_array_t(e32_t tag_ = MEM_TAG_GENERAL)
+		{
+			block = nullptr;
+			count = 0;
+			capacity = 0;
+			tag = tag_;
+
+			for (size_t i = 0; i < field_count; ++i)
+			{
+				columns[i] = nullptr;
+			}
+		}
+
+		~soa_array_t()
+		{
+			if (block != nullptr)
+			{
+				free_mem_aligned(block);
+			}
+		}
+
+		size_t get_count() const
+		{
+			return count;
+		}
+
+		size_t get_capacity() const
+		{
+			return capacity;
+		}
+
+		template<size_t index>
+		field_t<index>* get_column()
+		{
+			return (field_t<index>*)columns[index];
+		}
+
+		template<size_t index>
+		const field_t<index>* get_column() const
+		{
+			return (const field_t<index>*)columns[index];
+		}
+
+		template<size_t index>
+		field_t<index>& get(size_t row)
+		{
+			AUX_DEBUG_ASSERT(row < count);
+
+			return get_column<index>()[row];
+		}
+
+		template<size_t index>
+		const field_t<index>& get(size_t row) const
+		{
+			AUX_DEBUG_ASSERT(row < count);
+
+			return get_column<index>()[row];
+		}
+
+		// Values may point into the columns, so the old block is kept until the row is stored
+		size_t push(const fields_t&... values)
+		{
+			u8_t* old_block = reserve_for(count + 1);
+			store_row(count, typename make_index_list_t<field_count>::type(), values...);
+			release(old_block);
+			return count++;
+		}
+
+		// New rows are zeroed, the index of the first one is returned
+		size_t push_many(size_t size)
+		{
+			release(reserve_for(count + size));
+			const size_t sizes[] = { sizeof(fields_t)... };
+
+			for (size_t i = 0; i < field_count; ++i)
+			{
+				zero_mem(columns[i] + sizes[i] * count, sizes[i] * size);
+			}
+
+			size_t first = count;
+			count += size;
+			return first;
+		}
+
+		// Moves the last row into the hole, so row order is not kept
+		void erase_swap(size_t row)
+		{
+			AUX_DEBUG_ASSERT(row < count);
+
+			--count;
+
+			if (row != count)
+			{
+				const size_t sizes[] = { sizeof(fields_t)... };
+
+				for (size_t i = 0; i < field_count; ++i)
+				{
+					copy_mem(columns[i] + sizes[i] * count, columns[i] + sizes[i] * row, sizes[i]);
+				}
+			}
+		}
+
+		// Rows are visited from the back, so a row swapped into a hole has already been tested
+		template<typename F>
+		size_t erase_swap_if(F pred)
+		{
+			size_t erased = 0;
+
+			for (size_t row = count; row > 0; --row)
+			{
+				if (pred(row - 1))
+				{
+					erase_swap(row - 1);
+					++erased;
+				}
+			}
+
+			return erased;
+		}
+
+		void resize(size_t size)
+		{
+			if (size > count)
+			{
+				push_many(size - count);
+				return;
+			}
+
+			count = size;
+		}
+
+		void clear()
+		{
+			count = 0;
+		}
+
+		void reserve(size_t size)
+		{
+			if (size > capacity)
+			{
+				release(relocate(size));
+			}
+		}
+
+		// Hands the row count and the requested columns to func, e.g. for_columns<0, 2>(func) calls func(count, column0, column2)
+		template<size_t... indices, typename F>
+		void for_columns(F func)
+		{
+			func(count, get_column<indices>()...);
+		}
+
+	private:
+
+		u8_t* columns[field_count];
+		u8_t* block;
+		size_t count;
+		size_t capacity;
+		e32_t tag;
+
+		template<size_t... indices>
+		void store_row(size_t row, index_list_t<indices...>, const fields_t&... values)
+		{
+			i32_t expand[] = { 0, ((void)(get_column<indices>()[row] = values), 0)... };
+			(void)expand;
+		}
+
+		u8_t* reserve_for(size_t size)
+		{
+			if (size > capacity)
+			{
+				return relocate(max_of<size_t>(max_of<size_t>(capacity * 2, 16), size));
+			}
+
+			return nullptr;
+		}
+
+		void release(u8_t* old_block)
+		{
+			if (old_block != nullptr)
+			{
+				free_mem_aligned(old_block);
+			}
+		}
+
+		// Returns the previous block, which the caller frees once nothing reads from it
+		u8_t* relocate(size_t new_capacity)
+		{
+			const size_t sizes[] = { sizeof(fields_t)... };
+			size_t offsets[field_count];
+			size_t total = 0;
+
+			for (size_t i = 0; i < field_count; ++i)
+			{
+				offsets[i] = total;
+				total += (sizes[i] * new_capacity + cache_line_size - 1) & ~(cache_line_size - 1);
+			}
+
+			u8_t* new_block = (u8_t*)alloc_mem_aligned(total, cache_line_size, tag);
+
+			for (size_t i = 0; i < field_count; ++i)
+			{
+				if (count > 0)
+				{
+					copy_mem(columns[i], new_block + offsets[i], sizes[i] * count);
+				}
+
+				columns[i] = new_block + offsets[i];
+			}
+
+			u8_t* old_block = block;
+			block = new_block;
+			capacity = new_capacity;
+			return old_block;
+		}
+	};
+}
@@ -0,0 +1,447 @@
+#include "sort.h"
+#include "thread.h"
+
+#pragma warning(push, 0)
+
+#include <new>
+#include <intrin.h>
+#include <xmmintrin.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	static const u32_t radix_bits = 8;
+	static const u32_t radix_size = 1 << radix_bits;
+	static const u32_t max_sort_workers = 64;
+	// Below this many keys per worker the wakeups cost more than the split saves
+	static const size_t min_worker_keys = 32768;
+	static const size_t prefetch_distance = 64;
+
+	typedef void(*sort_job_handler_t)(void* context, u32_t worker);
+
+	struct sort_worker_t
+	{
+		sort_pool_t* pool;
+		thread_t* thread;
+		u32_t index;
+	};
+
+	struct sort_pool_t
+	{
+		alignas(cache_line_size) volatile u32_t generation;
+		alignas(cache_line_size) volatile u32_t pending;
+		sort_job_handler_t job_handler;
+		void* job_context;
+		u32_t job_worker_count;
+		bool quit;
+		u32_t thread_count;
+		sort_worker_t* workers;
+	};
+
+	template<typename key_t>
+	struct radix_state_t
+	{
+		key_t* src_keys;
+		key_t* dst_keys;
+		u32_t* src_indices;
+		u32_t* dst_indices;
+		size_t count;
+		size_t* counts;
+		u32_t worker_count;
+		u32_t digit;
+		bool is_float;
+	};
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static i32_t run_sort_worker(void* user_ptr)
+	{
+		sort_worker_t* worker = (sort_worker_t*)user_ptr;
+		sort_pool_t* pool = worker->pool;
+		u32_t seen = 0;
+
+		for (;;)
+		{
+			u32_t generation = pool->generation;
+
+			if (generation == seen)
+			{
+				wait_on_value(&pool->generation, seen);
+				continue;
+			}
+
+			seen = generation;
+
+			if (pool->quit)
+			{
+				return 0;
+			}
+
+			if (worker->index < pool->job_worker_count)
+			{
+				pool->job_handler(pool->job_context, worker->index);
+			}
+
+			if (_InterlockedDecrement((volatile long*)&pool->pending) == 0)
+			{
+				wake_all_waiters(&pool->pending);
+			}
+		}
+	}
+
+	// The calling thread runs share 0 and returns once every share is done
+	static void run_sort_job(sort_pool_t* pool, u32_t worker_count, sort_job_handler_t handler, void* context)
+	{
+		if (worker_count > 1)
+		{
+			pool->job_handler = handler;
+			pool->job_context = context;
+			pool->job_worker_count = worker_count;
+			pool->pending = pool->thread_count;
+			_InterlockedIncrement((volatile long*)&pool->generation);
+			wake_all_waiters(&pool->generation);
+		}
+
+		handler(context, 0);
+
+		if (worker_count > 1)
+		{
+			for (;;)
+			{
+				u32_t pending = pool->pending;
+
+				if (pending == 0)
+				{
+					break;
+				}
+
+				wait_on_value(&pool->pending, pending);
+			}
+		}
+	}
+
+	// Negative floats have every bit flipped and positive ones just the sign, so their bits order like unsigned integers
+	template<typename key_t>
+	static key_t flip_float(key_t key)
+	{
+		const key_t sign = (key_t)1 << (sizeof(key_t) * 8 - 1);
+		return key ^ ((key & sign) ? ~(key_t)0 : sign);
+	}
+
+	template<typename key_t>
+	static key_t unflip_float(key_t key)
+	{
+		const key_t sign = (key_t)1 << (sizeof(key_t) * 8 - 1);
+		return key ^ ((key & sign) ? sign : ~(key_t)0);
+	}
+
+	template<typename key_t>
+	static void get_worker_range(const radix_state_t<key_t>& state, u32_t worker, size_t& first, size_t& last)
+	{
+		first = state.count * worker / state.worker_count;
+		last = state.count * (worker + 1) / state.worker_count;
+	}
+
+	// One read builds the histograms of every digit, which also shows the passes that can be skipped
+	template<typename key_t>
+	static void count_all_digits(void* context, u32_t worker)
+	{
+		radix_state_t<key_t>& state = *(radix_state_t<key_t>*)context;
+		const u32_t digit_count = sizeof(key_t);
+		size_t* counts = state.counts + (size_t)worker * digit_count * radix_size;
+		key_t* keys = state.src_keys;
+		size_t first;
+		size_t last;
+		get_worker_range(state, worker, first, last);
+		zero_mem(counts, sizeof(size_t) * digit_count * radix_size);
+
+		for (size_t i = first; i < last; ++i)
+		{
+			key_t key = keys[i];
+
+			if (state.is_float)
+			{
+				key = flip_float(key);
+				keys[i] = key;
+			}
+
+			for (u32_t d = 0; d < digit_count; ++d)
+			{
+				++counts[d * radix_size + (size_t)((key >> (d * radix_bits)) & (radix_size - 1))];
+			}
+		}
+	}
+
+	template<typename key_t>
+	static void count_digit(void* context, u32_t worker)
+	{
+		radix_state_t<key_t>& state = *(radix_state_t<key_t>*)context;
+		size_t* counts = state.counts + ((size_t)worker * sizeof(key_t) + state.digit) * radix_size;
+		const key_t* keys = state.src_keys;
+		u32_t shift = state.digit * radix_bits;
+		size_t first;
+		size_t last;
+		get_worker_range(state, worker, first, last);
+		zero_mem(counts, sizeof(size_t) * radix_size);
+
+		for (size_t i = first; i < last; ++i)
+		{
+			++counts[(size_t)((keys[i] >> shift) & (radix_size - 1))];
+		}
+	}
+
+	// Expects the counts of the current digit to have been turned into the worker's first output positions
+	template<typename key_t>
+	static void scatter_digit(void* context, u32_t worker)
+	{
+		radix_state_t<key_t>& state = *(radix_state_t<key_t>*)context;
+		size_t* offsets = state.counts + ((size_t)worker * sizeof(key_t) + state.digit) * radix_size;
+		const key_t* src_keys = state.src_keys;
+		key_t* dst_keys = state.dst_keys;
+		const u32_t* src_indices = state.src_indices;
+		u32_t* dst_indices = state.dst_indices;
+		u32_t shift = state.digit * radix_bits;
+		size_t first;
+		size_t last;
+		get_worker_range(state, worker, first, last);
+
+		for (size_t i = first; i < last; ++i)
+		{
+			// The input is streamed in order, the bucket tails it scatters into are what miss
+			if (i + prefetch_distance < last)
+			{
+				size_t ahead = offsets[(size_t)((src_keys[i + prefetch_distance] >> shift) & (radix_size - 1))];
+				_mm_prefetch((const char*)(dst_keys + ahead), _MM_HINT_T0);
+			}
+
+			key_t key = src_keys[i];
+			size_t pos = offsets[(size_t)((key >> shift) & (radix_size - 1))]++;
+			dst_keys[pos] = key;
+
+			if (src_indices != nullptr)
+			{
+				dst_indices[pos] = src_indices[i];
+			}
+		}
+	}
+
+	template<typename key_t>
+	static void unflip_keys(void* context, u32_t worker)
+	{
+		radix_state_t<key_t>& state = *(radix_state_t<key_t>*)context;
+		key_t* keys = state.src_keys;
+		size_t first;
+		size_t last;
+		get_worker_range(state, worker, first, last);
+
+		for (size_t i = first; i < last; ++i)
+		{
+			keys[i] = unflip_float(keys[i]);
+		}
+	}
+
+	template<typename key_t>
+	static void sort_radix(key_t* keys, u32_t* indices, key_t* temp_keys, u32_t* temp_indices, size_t count, sort_pool_t* pool, bool is_float)
+	{
+		AUX_DEBUG_ASSERT((keys != nullptr) || (count == 0));
+		AUX_DEBUG_ASSERT((temp_keys != nullptr) || (count == 0));
+		AUX_DEBUG_ASSERT((indices == nullptr) || (temp_indices != nullptr));
+
+		if (count < 2)
+		{
+			return;
+		}
+
+		const u32_t digit_count = sizeof(key_t);
+		u32_t worker_count = 1;
+
+		if (pool != nullptr)
+		{
+			worker_count = (u32_t)min_of<size_t>(pool->thread_count + 1, count / min_worker_keys);
+			worker_count = max_of<u32_t>(worker_count, 1);
+		}
+
+		radix_state_t<key_t> state;
+		state.src_keys = keys;
+		state.dst_keys = temp_keys;
+		state.src_indices = indices;
+		state.dst_indices = temp_indices;
+		state.count = count;
+		state.counts = (size_t*)alloc_mem(sizeof(size_t) * worker_count * digit_count * radix_size);
+		state.worker_count = worker_count;
+		state.digit = 0;
+		state.is_float = is_float;
+		run_sort_job(pool, worker_count, &count_all_digits<key_t>, &state);
+
+		// Until the first pass runs, every worker still owns the keys it counted
+		bool recount = false;
+
+		for (u32_t d = 0; d < digit_count; ++d)
+		{
+			state.digit = d;
+			size_t total = 0;
+
+			for (u32_t w = 0; w < worker_count; ++w)
+			{
+				total += state.counts[((size_t)w * digit_count + d) * radix_size + (size_t)((state.src_keys[0] >> (d * radix_bits)) & (radix_size - 1))];
+			}
+
+			if (total == count)
+			{
+				continue;
+			}
+
+			if (recount)
+			{
+				run_sort_job(pool, worker_count, &count_digit<key_t>, &state);
+			}
+
+			// Buckets are laid out in order and each bucket is split between the workers in order, which keeps the pass stable
+			size_t offset = 0;
+
+			for (u32_t b = 0; b < radix_size; ++b)
+			{
+				for (u32_t w = 0; w < worker_count; ++w)
+				{
+					size_t& slot = state.counts[((size_t)w * digit_count + d) * radix_size + b];
+					size_t bucket_count = slot;
+					slot = offset;
+					offset += bucket_count;
+				}
+			}
+
+			run_sort_job(pool, worker_count, &scatter_digit<key_t>, &state);
+			key_t* keys_swap = state.src_keys;
+			state.src_keys = state.dst_keys;
+			state.dst_keys = keys_swap;
+			u32_t* indices_swap = state.src_indices;
+			state.src_indices = state.dst_indices;
+			state.dst_indices = indices_swap;
+			recount = worker_count > 1;
+		}
+
+		if (state.src_keys != keys)
+		{
+			copy_mem(state.src_keys, keys, sizeof(key_t) * count);
+
+			if (indices != nullptr)
+			{
+				copy_mem(state.src_indices, indices, sizeof(u32_t) * count);
+			}
+
+			state.src_keys = keys;
+		}
+
+		if (is_float)
+		{
+			run_sort_job(pool, worker_count, &unflip_keys<key_t>, &state);
+		}
+
+		free_mem(state.counts);
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Sort functions
+	//
+	///////////////////////////////////////////////////////////
+
+	sort_pool_t* create_sort_pool(u32_t thread_count)
+	{
+		thread_count = min_of<u32_t>(thread_count, max_sort_workers - 1);
+
+		sort_pool_t* pool = new (alloc_mem_aligned(sizeof(sort_pool_t), alignof(sort_pool_t))) sort_pool_t;
+		pool->generation = 0;
+		pool->pending = 0;
+		pool->job_handler = nullptr;
+		pool->job_context = nullptr;
+		pool->job_worker_count = 0;
+		pool->quit = false;
+		pool->thread_count = 0;
+		pool->workers = (sort_worker_t*)alloc_mem(sizeof(sort_worker_t) * max_of<u32_t>(thread_count, 1));
+
+		for (u32_t i = 0; i < thread_count; ++i)
+		{
+			sort_worker_t& worker = pool->workers[i];
+			worker.pool = pool;
+			worker.index = i + 1;
+			worker.thread = start_thread(&run_sort_worker, &worker);
+
+			if (worker.thread == nullptr)
+			{
+				break;
+			}
+
+			++pool->thread_count;
+		}
+
+		return pool;
+	}
+
+	void destroy_sort_pool(sort_pool_t* pool)
+	{
+		if (pool == nullptr)
+		{
+			return;
+		}
+
+		pool->quit = true;
+		_InterlockedIncrement((volatile long*)&pool->generation);
+		wake_all_waiters(&pool->generation);
+
+		for (u32_t i = 0; i < pool->thread_count; ++i)
+		{
+			wait_thread(pool->workers[i].thread);
+			free_thread(pool->workers[i].thread);
+		}
+
+		free_mem(pool->workers);
+		pool->~sort_pool_t();
+		free_mem_aligned(pool);
+	}
+
+	void radix_sort(u32_t* keys, u32_t* temp, size_t count, sort_pool_t* pool)
+	{
+		sort_radix<u32_t>(keys, nullptr, temp, nullptr, count, pool, false);
+	}
+
+	void radix_sort(u64_t* keys, u64_t* temp, size_t count, sort_pool_t* pool)
+	{
+		sort_radix<u64_t>(keys, nullptr, temp, nullptr, count, pool, false);
+	}
+
+	void radix_sort(f32_t* keys, f32_t* temp, size_t count, sort_pool_t* pool)
+	{
+		sort_radix<u32_t>((u32_t*)keys, nullptr, (u32_t*)temp, nullptr, count, pool, true);
+	}
+
+	void radix_sort(f64_t* keys, f64_t* temp, size_t count, sort_pool_t* pool)
+	{
+		sort_radix<u64_t>((u64_t*)keys, nullptr, (u64_t*)temp, nullptr, count, pool, true);
+	}
+
+	void radix_sort(u32_t* keys, u32_t* indices, u32_t* temp_keys, u32_t* temp_indices, size_t count, sort_pool_t* pool)
+	{
+		sort_radix<u32_t>(keys, indices, temp_keys, temp_indices, count, pool, false);
+	}
+
+	void radix_sort(u64_t* keys, u32_t* indices, u64_t* temp_keys, u32_t* temp_indices, size_t count, sort_pool_t* pool)
+	{
+		sort_radix<u64_t>(keys, indices, temp_keys, temp_indices, count, pool, false);
+	}
+
+	void radix_sort(f32_t* keys, u32_t* indices, f32_t* temp_keys, u32_t* temp_indices, size_t count, sort_pool_t* pool)
+	{
+		sort_radix<u32_t>((u32_t*)keys, indices, (u32_t*)temp_keys, temp_indices, count, pool, true);
+	}
+
+	void radix_sort(f64_t* keys, u32_t* indices, f64_t* temp_keys, u32_t* temp_indices, size_t count, sort_pool_t* pool)
+	{
+		sort_radix<u64_t>((u64_t*)keys, indices, (u64_t*)temp_keys, temp_indices, count, pool, true);
+	}
+}
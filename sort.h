@@ -0,0 +1,24 @@
+#pragma once
+
+#include "base.h"
+
+namespace aux
+{
+	struct sort_pool_t;
+
+	// Threads that share radix sort passes with the calling thread, a pool runs one sort at a time
+	sort_pool_t* create_sort_pool(u32_t thread_count);
+	void destroy_sort_pool(sort_pool_t* pool);
+
+	// Stable ascending LSD radix sorts, temp must hold count items and is clobbered
+	void radix_sort(u32_t* keys, u32_t* temp, size_t count, sort_pool_t* pool = nullptr);
+	void radix_sort(u64_t* keys, u64_t* temp, size_t count, sort_pool_t* pool = nullptr);
+	void radix_sort(f32_t* keys, f32_t* temp, size_t count, sort_pool_t* pool = nullptr);
+	void radix_sort(f64_t* keys, f64_t* temp, size_t count, sort_pool_t* pool = nullptr);
+
+	// Indices move along with their keys, so passing 0 to count - 1 yields the sorting permutation
+	void radix_sort(u32_t* keys, u32_t* indices, u32_t* temp_keys, u32_t* temp_indices, size_t count, sort_pool_t* pool = nullptr);
+	void radix_sort(u64_t* keys, u32_t* indices, u64_t* temp_keys, u32_t* temp_indices, size_t count, sort_pool_t* pool = nullptr);
+	void radix_sort(f32_t* keys, u32_t* indices, f32_t* temp_keys, u32_t* temp_indices, size_t count, sort_pool_t* pool = nullptr);
+	void radix_sort(f64_t* keys, u32_t* indices, f64_t* temp_keys, u32_t* temp_indices, size_t count, sort_pool_t* pool = nullptr);
+}
@@ -0,0 +1,318 @@
+#pragma once
+
+#include "base.h"
+
+#pragma warning(push, 0)
+
+#include <new>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	const u32_t invalid_sparse_index = UINT32_MAX;
+
+	// Sparse entries live in pages allocated on first use, so a large id space only pays for the ids it touches
+	class sparse_set_t
+	{
+	public:
+
+		sparse_set_t(const sparse_set_t&) = delete;
+		sparse_set_t& operator = (const sparse_set_t&) = delete;
+
+		explicit sparse_set_t(e32_t tag_ = MEM_TAG_GENERAL)
+		{
+			pages = nullptr;
+			ids = nullptr;
+			page_count = 0;
+			count = 0;
+			capacity = 0;
+			tag = tag_;
+		}
+
+		~sparse_set_t()
+		{
+			for (u32_t i = 0; i < page_count; ++i)
+			{
+				if (pages[i] != nullptr)
+				{
+					free_mem(pages[i]);
+				}
+			}
+
+			if (pages != nullptr)
+			{
+				free_mem(pages);
+			}
+
+			if (ids != nullptr)
+			{
+				free_mem(ids);
+			}
+		}
+
+		u32_t find(u32_t id) const
+		{
+			u32_t page = id >> page_bits;
+
+			if ((page >= page_count) || (pages[page] == nullptr))
+			{
+				return invalid_sparse_index;
+			}
+
+			u32_t index = pages[page][id & page_mask];
+			return ((index < count) && (ids[index] == id)) ? index : invalid_sparse_index;
+		}
+
+		bool contains(u32_t id) const
+		{
+			return find(id) != invalid_sparse_index;
+		}
+
+		u32_t insert(u32_t id)
+		{
+			u32_t index = find(id);
+
+			if (index != invalid_sparse_index)
+			{
+				return index;
+			}
+
+			if (count == capacity)
+			{
+				grow_ids();
+			}
+
+			index = count++;
+			ids[index] = id;
+			get_page(id >> page_bits)[id & page_mask] = index;
+			return index;
+		}
+
+		// The last id is moved into the hole, the hole's index is returned so parallel arrays can follow
+		u32_t remove(u32_t id)
+		{
+			u32_t index = find(id);
+
+			if (index == invalid_sparse_index)
+			{
+				return invalid_sparse_index;
+			}
+
+			u32_t last_id = ids[--count];
+			ids[index] = last_id;
+			pages[last_id >> page_bits][last_id & page_mask] = index;
+			return index;
+		}
+
+		void clear()
+		{
+			count = 0;
+		}
+
+		u32_t get_count() const
+		{
+			return count;
+		}
+
+		u32_t get_capacity() const
+		{
+			return capacity;
+		}
+
+		const u32_t* get_ids() const
+		{
+			return ids;
+		}
+
+	private:
+
+		static const u32_t page_bits = 12;
+		static const u32_t page_size = 1 << page_bits;
+		static const u32_t page_mask = page_size - 1;
+
+		u32_t** pages;
+		u32_t* ids;
+		u32_t page_count;
+		u32_t count;
+		u32_t capacity;
+		e32_t tag;
+
+		u32_t* get_page(u32_t page)
+		{
+			if (page >= page_count)
+			{
+				u32_t new_page_count = max_of<u32_t>(page + 1, page_count * 2);
+				u32_t** new_pages = (u32_t**)zalloc_mem_tagged(sizeof(u32_t*) * new_page_count, tag);
+
+				if (pages != nullptr)
+				{
+					copy_mem(pages, new_pages, sizeof(u32_t*) * page_count);
+					free_mem(pages);
+				}
+
+				pages = new_pages;
+				page_count = new_page_count;
+			}
+
+			if (pages[page] == nullptr)
+			{
+				pages[page] = (u32_t*)zalloc_mem_tagged(sizeof(u32_t) * page_size, tag);
+			}
+
+			return pages[page];
+		}
+
+		void grow_ids()
+		{
+			AUX_DEBUG_ASSERT(capacity < UINT32_MAX / 2);
+
+			u32_t new_capacity = (capacity == 0) ? 16 : capacity * 2;
+			u32_t* new_ids = (u32_t*)alloc_mem_tagged(sizeof(u32_t) * new_capacity, tag);
+
+			if (ids != nullptr)
+			{
+				copy_mem(ids, new_ids, sizeof(u32_t) * count);
+				free_mem(ids);
+			}
+
+			ids = new_ids;
+			capacity = new_capacity;
+		}
+	};
+
+	// Values sit densely in the same order as the set's ids and are relocated with copy_mem, so T must be trivially relocatable
+	template<typename T>
+	class sparse_map_t
+	{
+	public:
+
+		sparse_map_t(const sparse_map_t&) = delete;
+		sparse_map_t& operator = (const sparse_map_t&) = delete;
+
+		explicit sparse_map_t(e32_t tag_ = MEM_TAG_GENERAL) : set(tag_)
+		{
+			values = nullptr;
+			capacity = 0;
+			tag = tag_;
+		}
+
+		~sparse_map_t()
+		{
+			clear();
+
+			if (values != nullptr)
+			{
+				free_mem(values);
+			}
+		}
+
+		T* find(u32_t id)
+		{
+			u32_t index = set.find(id);
+			return (index != invalid_sparse_index) ? &values[index] : nullptr;
+		}
+
+		const T* find(u32_t id) const
+		{
+			u32_t index = set.find(id);
+			return (index != invalid_sparse_index) ? &values[index] : nullptr;
+		}
+
+		bool contains(u32_t id) const
+		{
+			return set.contains(id);
+		}
+
+		T& set_value(u32_t id, const T& value)
+		{
+			u32_t count = set.get_count();
+			u32_t index = set.insert(id);
+
+			if (index < count)
+			{
+				values[index] = value;
+				return values[index];
+			}
+
+			if (set.get_capacity() > capacity)
+			{
+				grow_values(set.get_capacity(), count);
+			}
+
+			return *new (values + index) T(value);
+		}
+
+		bool remove(u32_t id)
+		{
+			u32_t index = set.find(id);
+
+			if (index == invalid_sparse_index)
+			{
+				return false;
+			}
+
+			values[index].~T();
+			set.remove(id);
+			u32_t last = set.get_count();
+
+			if (index != last)
+			{
+				copy_mem(values + last, values + index, sizeof(T));
+			}
+
+			return true;
+		}
+
+		void clear()
+		{
+			for (u32_t i = 0; i < set.get_count(); ++i)
+			{
+				values[i].~T();
+			}
+
+			set.clear();
+		}
+
+		u32_t get_count() const
+		{
+			return set.get_count();
+		}
+
+		const u32_t* get_ids() const
+		{
+			return set.get_ids();
+		}
+
+		T* get_values()
+		{
+			return values;
+		}
+
+		const T* get_values() const
+		{
+			return values;
+		}
+
+	private:
+
+		sparse_set_t set;
+		T* values;
+		u32_t capacity;
+		e32_t tag;
+
+		void grow_values(u32_t new_capacity, u32_t count)
+		{
+			T* new_values = (T*)alloc_mem_tagged(sizeof(T) * new_capacity, tag);
+
+			if (values != nullptr)
+			{
+				copy_mem(values, new_values, sizeof(T) * count);
+				free_mem(values);
+			}
+
+			values = new_values;
+			capacity = new_capacity;
+		}
+	};
+}
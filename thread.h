@@ -7,11 +7,54 @@ namespace aux
 	struct thread_t;
 	typedef i32_t(*thread_handler_t)(void* user_ptr);
 
+	// Slim reader/writer lock that needs no creation, a zeroed lock_t is unlocked
+	struct lock_t
+	{
+		void* state;
+	};
+
 	thread_t* start_thread(thread_handler_t handler, void* user_ptr = nullptr);
 	void free_thread(thread_t* thread);
 
 	void wait_thread(thread_t* thread);
 	bool wait_thread(thread_t* thread, u32_t timeout_msec);
 
+	bool bind_thread_to_numa_node(thread_t* thread, u32_t node);
+	bool bind_current_thread_to_numa_node(u32_t node);
+
 	void suspend_current_thread(u32_t duration_msec);
+
+	// Sleeps while the value at the address still equals value, callers must recheck since wakeups can be spurious
+	void wait_on_value(const volatile u32_t* address, u32_t value);
+	bool wait_on_value(const volatile u32_t* address, u32_t value, u32_t timeout_msec);
+	void wake_single_waiter(const volatile u32_t* address);
+	void wake_all_waiters(const volatile u32_t* address);
+
+	void acquire_lock(lock_t& lock);
+	bool try_acquire_lock(lock_t& lock);
+	void release_lock(lock_t& lock);
+	void acquire_shared_lock(lock_t& lock);
+	void release_shared_lock(lock_t& lock);
+
+	class lock_scope_t
+	{
+	public:
+
+		lock_scope_t(const lock_scope_t&) = delete;
+		lock_scope_t& operator = (const lock_scope_t&) = delete;
+
+		explicit lock_scope_t(lock_t& lock_) : lock(lock_)
+		{
+			acquire_lock(lock);
+		}
+
+		~lock_scope_t()
+		{
+			release_lock(lock);
+		}
+
+	private:
+
+		lock_t& lock;
+	};
 }
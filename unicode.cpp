@@ -212,7 +212,7 @@ namespace aux
 
 		if (len16 > 0)
 		{
-			u16_t* utf16 = (u16_t*)alloc_mem(((size_t)len16 + 1) * sizeof(u16_t));
+			u16_t* utf16 = (u16_t*)alloc_mem_tagged(((size_t)len16 + 1) * sizeof(u16_t), MEM_TAG_UNICODE);
 			convert(utf8, utf16, bad_char);
 			utf16[len16] = 0;
 			return utf16;
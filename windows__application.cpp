@@ -25,6 +25,16 @@ namespace aux
 
 	static const i32_t min_client_size = 240;
 
+	// Each of the three buffers reserves this much, 32-bit builds keep the total well below their address space
+	#if defined(_M_X64)
+	static const size_t frame_mem_capacity = 256 * 1024 * 1024;
+	#else
+	static const size_t frame_mem_capacity = 64 * 1024 * 1024;
+	#endif
+	static const size_t frame_mem_commit_size = 64 * 1024;
+	static const size_t frame_mem_alignment = 16;
+	static const i32_t frame_mem_count = 3;
+
 	#pragma pack(1)
 
 	struct window_shape_t
@@ -53,7 +63,17 @@ namespace aux
 
 	#pragma pack()
 
+	struct alignas(cache_line_size) frame_mem_t
+	{
+		vm_buffer_t* buffer;
+		volatile LONG64 pos;
+		volatile LONG64 committed;
+	};
+
 	static app_t* app = nullptr;
+	static frame_mem_t frame_mems[frame_mem_count] = {};
+	static SRWLOCK frame_mem_lock = SRWLOCK_INIT;
+	static u32_t frame_count = 0;
 	app_handler_t app_handler = {};
 
 	///////////////////////////////////////////////////////////
@@ -303,6 +323,35 @@ namespace aux
 		}
 	}
 
+	// Slot 0 lives for one frame, slots 1 and 2 alternate and live for two
+	static void init_frame_mem()
+	{
+		for (i32_t i = 0; i < frame_mem_count; ++i)
+		{
+			frame_mems[i].buffer = create_vm_buffer(frame_mem_capacity, MEM_TAG_APPLICATION);
+			frame_mems[i].pos = 0;
+			frame_mems[i].committed = 0;
+		}
+
+		frame_count = 0;
+	}
+
+	static void free_frame_mem()
+	{
+		for (i32_t i = 0; i < frame_mem_count; ++i)
+		{
+			destroy_vm_buffer(frame_mems[i].buffer);
+			frame_mems[i].buffer = nullptr;
+		}
+	}
+
+	static void advance_frame_mem()
+	{
+		++frame_count;
+		InterlockedExchange64(&frame_mems[0].pos, 0);
+		InterlockedExchange64(&frame_mems[1 + (frame_count & 1)].pos, 0);
+	}
+
 	static void suspend_main_loop(HWND window)
 	{
 		toggle_window_focus(window, false, false);
@@ -341,6 +390,8 @@ namespace aux
 		{
 			app_handler.on_redraw(app_handler.user_ptr);
 		}
+
+		advance_frame_mem();
 	}
 
 	static void run_main_loop()
@@ -595,7 +646,8 @@ namespace aux
 	{
 		AUX_DEBUG_ASSERT(app == nullptr);
 
-		app = (app_t*)zalloc_mem(sizeof(app_t));
+		app = (app_t*)zalloc_mem_tagged(sizeof(app_t), MEM_TAG_APPLICATION);
+		init_frame_mem();
 
 		if (SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED)))
 		{
@@ -637,6 +689,7 @@ namespace aux
 			CoUninitialize();
 		}
 
+		free_frame_mem();
 		free_mem(app);
 		app = nullptr;
 	}
@@ -652,6 +705,34 @@ namespace aux
 		}
 	}
 
+	void* alloc_frame_mem(size_t size, e32_t lifetime)
+	{
+		AUX_DEBUG_ASSERT(app != nullptr);
+		AUX_DEBUG_ASSERT(size > 0);
+		AUX_DEBUG_ASSERT((lifetime >= 0) && (lifetime < FRAME_LIFETIME_MAX_ENUMS));
+
+		frame_mem_t& frame_mem = (lifetime == FRAME_LIFETIME_NEXT) ? frame_mems[1 + (frame_count & 1)] : frame_mems[0];
+		size = (size + frame_mem_alignment - 1) & ~(frame_mem_alignment - 1);
+		LONG64 end = InterlockedExchangeAdd64(&frame_mem.pos, (LONG64)size) + (LONG64)size;
+
+		// Only committing new pages takes the lock, the bump itself stays lock free
+		if (end > frame_mem.committed)
+		{
+			AcquireSRWLockExclusive(&frame_mem_lock);
+
+			if (end > frame_mem.committed)
+			{
+				size_t committed = ((size_t)end + frame_mem_commit_size - 1) & ~(frame_mem_commit_size - 1);
+				resize_vm_buffer(frame_mem.buffer, committed);
+				InterlockedExchange64(&frame_mem.committed, (LONG64)committed);
+			}
+
+			ReleaseSRWLockExclusive(&frame_mem_lock);
+		}
+
+		return (u8_t*)get_vm_buffer_data(frame_mem.buffer) + ((size_t)end - size);
+	}
+
 	void reshape_app(e32_t style, const size2_t& res)
 	{
 		HWND window = app->window;
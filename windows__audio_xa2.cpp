@@ -110,7 +110,7 @@ namespace aux
 
 	bool internal__init_audio(HWND window)
 	{
-		audio = (audio_t*)zalloc_mem(sizeof(audio_t));
+		audio = (audio_t*)zalloc_mem_tagged(sizeof(audio_t), MEM_TAG_AUDIO);
 		audio->window = window;
 
 		if (!create_device_and_master_voice())
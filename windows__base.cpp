@@ -3,7 +3,9 @@
 #pragma warning(push, 0)
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <math.h>
+#include <intrin.h>
 
 #define WIN32_LEAN_AND_MEAN
 #define STRICT
@@ -15,8 +17,146 @@
 
 #pragma warning(pop)
 
+#pragma comment(lib, "advapi32.lib")
+
 namespace aux
 {
+	static const size_t arena_alignment = 16;
+	static const size_t vm_commit_size = 64 * 1024;
+	static const size_t slab_size = 64 * 1024;
+	static const size_t slab_header_size = 16;
+	static const size_t small_mem_granularity = 16;
+	static const size_t small_mem_max_size = 256;
+	static const size_t small_mem_classes = small_mem_max_size / small_mem_granularity;
+	static const size_t mem_header_size = 16;
+	static const i64_t mem_flush_threshold = 64 * 1024;
+	static const size_t small_copy_size = 16;
+	static const size_t huge_header_size = 64;
+	static const i32_t max_mem_reclaimers = 32;
+	static const u32_t mem_flag_sampled = 1;
+
+	#pragma pack(1)
+
+	struct mem_header_t
+	{
+		u64_t size;
+		e32_t tag;
+		u32_t flags;
+	};
+
+	struct huge_header_t
+	{
+		u64_t size;
+		u64_t mapped_size;
+		e32_t tag;
+		bool backed;
+	};
+
+	struct arena_t
+	{
+		u8_t* base;
+		size_t capacity;
+		size_t committed;
+		size_t pos;
+		size_t dirty;
+	};
+
+	struct vm_buffer_t
+	{
+		u8_t* base;
+		size_t capacity;
+		size_t committed;
+		size_t size;
+		e32_t tag;
+	};
+
+	#pragma pack()
+
+	struct alignas(cache_line_size) slab_pool_t
+	{
+		SLIST_HEADER free_items;
+		SRWLOCK lock;
+		u8_t* slabs;
+		size_t slab_pos;
+		size_t item_size;
+	};
+
+	struct mem_sample_t
+	{
+		mem_sample_t* prev;
+		mem_sample_t* next;
+		i64_t weight;
+		u32_t hash;
+		u32_t frame_count;
+		void* frames[mem_site_max_frames];
+	};
+
+	struct mem_reclaimer_t
+	{
+		mem_reclaim_handler_t handler;
+		void* user_ptr;
+		i32_t priority;
+	};
+
+	struct mem_counters_t
+	{
+		mem_counters_t* prev;
+		mem_counters_t* next;
+		i64_t pending_bytes[MEM_TAG_MAX_ENUMS];
+		u64_t alloc_counts[MEM_TAG_MAX_ENUMS];
+		u64_t histograms[MEM_TAG_MAX_ENUMS][mem_histogram_size];
+		i64_t sample_countdown;
+		u64_t sample_seed;
+	};
+
+	static slab_pool_t small_pools[small_mem_classes] = {};
+	static e32_t mem_backend = MEM_BACKEND_SYSTEM;
+	static bool mem_backend_locked = false;
+
+	static volatile LONG64 live_bytes[MEM_TAG_MAX_ENUMS] = {};
+	static volatile LONG64 peak_bytes[MEM_TAG_MAX_ENUMS] = {};
+	static volatile LONG64 total_live_bytes = 0;
+	static volatile LONG64 total_peak_bytes = 0;
+	static mem_counters_t* counters_list = nullptr;
+	static mem_counters_t retired_counters = {};
+	static SRWLOCK counters_lock = SRWLOCK_INIT;
+	static DWORD counters_index = FLS_OUT_OF_INDEXES;
+	static __declspec(thread) mem_counters_t* thread_counters = nullptr;
+
+	static size_t mem_stream_threshold = 4 * 1024 * 1024;
+
+	static volatile LONG large_pages_state = 0;
+	static size_t large_page_size = 0;
+	static volatile LONG64 huge_live_bytes = 0;
+	static volatile LONG64 huge_backed_bytes = 0;
+	static u32_t numa_node_count = 0;
+	static __declspec(thread) i32_t thread_numa_node = -1;
+
+	static volatile LONG64 mem_sample_interval = 512 * 1024;
+	static mem_sample_t* samples_list = nullptr;
+	static SRWLOCK samples_lock = SRWLOCK_INIT;
+
+	static volatile LONG64 mem_soft_limit = 0;
+	static volatile LONG64 mem_hard_limit = 0;
+	static mem_reclaimer_t mem_reclaimers[max_mem_reclaimers] = {};
+	static i32_t mem_reclaimer_count = 0;
+	static SRWLOCK mem_reclaimers_lock = SRWLOCK_INIT;
+	static SRWLOCK mem_reclaim_lock = SRWLOCK_INIT;
+	static volatile LONG mem_reclaim_armed = 1;
+	static __declspec(thread) bool mem_reclaiming = false;
+
+	static volatile LONG cpu_features = -1;
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Internal functions
+	//
+	///////////////////////////////////////////////////////////
+
+	bool internal__init_heap();
+	void* internal__alloc_heap(size_t size, bool zeroed);
+	void internal__free_heap(void* mem);
+
 	///////////////////////////////////////////////////////////
 	//
 	//	Helper functions
@@ -29,126 +169,1897 @@ namespace aux
 		ExitProcess((UINT)-1);
 	}
 
-	///////////////////////////////////////////////////////////
-	//
-	//	Debug functions
-	//
-	///////////////////////////////////////////////////////////
+	static i32_t get_histogram_bucket(size_t size)
+	{
+		if (size <= 16)
+		{
+			return 0;
+		}
 
-	#if defined(AUX_DEBUG_ON)
+		unsigned long index;
 
-	void report_debug_error__SHOULD_NOT_BE_USED_DIRECTLY(const wchar_t message[])
+		#if defined(_M_X64)
+		_BitScanReverse64(&index, (u64_t)(size - 1));
+		#else
+		_BitScanReverse(&index, (unsigned long)(size - 1));
+		#endif
+
+		return min_of<i32_t>((i32_t)index - 3, mem_histogram_size - 1);
+	}
+
+	static void raise_peak(volatile LONG64* peak, i64_t value)
 	{
-		MessageBoxW(GetForegroundWindow(), message, L"DEBUG ERROR", MB_TOPMOST | MB_TASKMODAL | MB_ICONERROR | MB_OK);
-		DebugBreak();
+		LONG64 current = *peak;
+
+		while (value > current)
+		{
+			LONG64 prev = InterlockedCompareExchange64(peak, value, current);
+
+			if (prev == current)
+			{
+				break;
+			}
+
+			current = prev;
+		}
 	}
 
-	void begin_debug_memory_guard__SHOULD_NOT_BE_USED_DIRECTLY()
+	static void add_live_bytes(e32_t tag, i64_t delta)
 	{
-		_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+		raise_peak(&peak_bytes[tag], InterlockedExchangeAdd64(&live_bytes[tag], delta) + delta);
+		raise_peak(&total_peak_bytes, InterlockedExchangeAdd64(&total_live_bytes, delta) + delta);
 	}
 
-	void end_debug_memory_guard__SHOULD_NOT_BE_USED_DIRECTLY()
+	static void WINAPI on_counters_thread_exit(void* param)
 	{
-		_CrtDumpMemoryLeaks();
+		mem_counters_t* counters = (mem_counters_t*)param;
+
+		if (counters == nullptr)
+		{
+			return;
+		}
+
+		AcquireSRWLockExclusive(&counters_lock);
+
+		for (i32_t i = 0; i < MEM_TAG_MAX_ENUMS; ++i)
+		{
+			add_live_bytes(i, counters->pending_bytes[i]);
+			retired_counters.alloc_counts[i] += counters->alloc_counts[i];
+
+			for (i32_t j = 0; j < mem_histogram_size; ++j)
+			{
+				retired_counters.histograms[i][j] += counters->histograms[i][j];
+			}
+		}
+
+		if (counters->prev != nullptr)
+		{
+			counters->prev->next = counters->next;
+		}
+		else
+		{
+			counters_list = counters->next;
+		}
+
+		if (counters->next != nullptr)
+		{
+			counters->next->prev = counters->prev;
+		}
+
+		ReleaseSRWLockExclusive(&counters_lock);
+		HeapFree(GetProcessHeap(), 0, counters);
+		thread_counters = nullptr;
 	}
 
-	#endif
+	static mem_counters_t* get_thread_counters()
+	{
+		mem_counters_t* counters = thread_counters;
 
-	///////////////////////////////////////////////////////////
-	//
-	//	Math functions
-	//
-	///////////////////////////////////////////////////////////
+		if (counters != nullptr)
+		{
+			return counters;
+		}
 
-	template<>
-	f32_t min_of<f32_t>(f32_t lhs, f32_t rhs)
+		// Kept off the tracked heaps so the counters never count themselves
+		counters = (mem_counters_t*)HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(mem_counters_t));
+
+		if (counters == nullptr)
+		{
+			return nullptr;
+		}
+
+		AcquireSRWLockExclusive(&counters_lock);
+
+		if (counters_index == FLS_OUT_OF_INDEXES)
+		{
+			counters_index = FlsAlloc(&on_counters_thread_exit);
+		}
+
+		counters->next = counters_list;
+
+		if (counters_list != nullptr)
+		{
+			counters_list->prev = counters;
+		}
+
+		counters_list = counters;
+		ReleaseSRWLockExclusive(&counters_lock);
+
+		if (counters_index != FLS_OUT_OF_INDEXES)
+		{
+			FlsSetValue(counters_index, counters);
+		}
+
+		thread_counters = counters;
+		return counters;
+	}
+
+	static void count_alloc(e32_t tag, size_t size)
 	{
-		return fminf(lhs, rhs);
+		mem_counters_t* counters = get_thread_counters();
+
+		if (counters == nullptr)
+		{
+			add_live_bytes(tag, (i64_t)size);
+			return;
+		}
+
+		++counters->alloc_counts[tag];
+		++counters->histograms[tag][get_histogram_bucket(size)];
+		i64_t& pending = counters->pending_bytes[tag];
+		pending += (i64_t)size;
+
+		if (pending >= mem_flush_threshold)
+		{
+			add_live_bytes(tag, pending);
+			pending = 0;
+		}
 	}
 
-	template<>
-	f64_t min_of<f64_t>(f64_t lhs, f64_t rhs)
+	static void count_free(e32_t tag, size_t size)
 	{
-		return fmin(lhs, rhs);
+		mem_counters_t* counters = get_thread_counters();
+
+		if (counters == nullptr)
+		{
+			add_live_bytes(tag, -(i64_t)size);
+			return;
+		}
+
+		i64_t& pending = counters->pending_bytes[tag];
+		pending -= (i64_t)size;
+
+		if (pending <= -mem_flush_threshold)
+		{
+			add_live_bytes(tag, pending);
+			pending = 0;
+		}
 	}
 
-	template<>
-	f32_t max_of<f32_t>(f32_t lhs, f32_t rhs)
+	// Gaps are drawn from an exponential distribution, so periodic allocation patterns can not line up with them
+	static i64_t get_sample_gap(mem_counters_t* counters, i64_t interval)
 	{
-		return fmaxf(lhs, rhs);
+		u64_t seed = counters->sample_seed;
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		counters->sample_seed = seed;
+
+		f64_t uniform = (f64_t)((seed >> 11) + 1) * (1.0 / 9007199254740992.0);
+		return (i64_t)(-log(uniform) * (f64_t)interval) + 1;
 	}
 
-	template<>
-	f64_t max_of<f64_t>(f64_t lhs, f64_t rhs)
+	static bool should_sample(size_t size)
 	{
-		return fmax(lhs, rhs);
+		i64_t interval = mem_sample_interval;
+
+		if (interval == 0)
+		{
+			return false;
+		}
+
+		mem_counters_t* counters = get_thread_counters();
+
+		if (counters == nullptr)
+		{
+			return false;
+		}
+
+		// Each thread starts a random distance into its first gap instead of sampling its first allocation
+		if (counters->sample_seed == 0)
+		{
+			counters->sample_seed = (__rdtsc() ^ ((u64_t)GetCurrentThreadId() << 32) ^ (u64_t)(size_t)counters) | 1;
+			counters->sample_countdown = get_sample_gap(counters, interval);
+		}
+
+		counters->sample_countdown -= (i64_t)size;
+
+		if (counters->sample_countdown > 0)
+		{
+			return false;
+		}
+
+		counters->sample_countdown = get_sample_gap(counters, interval);
+		return true;
 	}
 
-	///////////////////////////////////////////////////////////
-	//
-	//	Memory functions
-	//
-	///////////////////////////////////////////////////////////
+	static mem_sample_t* record_sample(size_t size)
+	{
+		// Kept off the tracked heaps like the counters
+		mem_sample_t* sample = (mem_sample_t*)HeapAlloc(GetProcessHeap(), 0, sizeof(mem_sample_t));
 
-	void* alloc_mem(size_t size)
+		if (sample == nullptr)
+		{
+			return nullptr;
+		}
+
+		// An allocation of this size is sampled with probability 1 - exp(-size / interval), weighting by its inverse keeps site totals unbiased
+		ULONG hash = 0;
+		sample->frame_count = RtlCaptureStackBackTrace(2, mem_site_max_frames, sample->frames, &hash);
+		sample->hash = (u32_t)hash;
+		f64_t interval = (f64_t)max_of<i64_t>(mem_sample_interval, 1);
+		sample->weight = (i64_t)((f64_t)size / -expm1(-(f64_t)size / interval));
+		sample->prev = nullptr;
+		AcquireSRWLockExclusive(&samples_lock);
+		sample->next = samples_list;
+
+		if (samples_list != nullptr)
+		{
+			samples_list->prev = sample;
+		}
+
+		samples_list = sample;
+		ReleaseSRWLockExclusive(&samples_lock);
+		return sample;
+	}
+
+	static void release_sample(mem_sample_t* sample)
 	{
-		AUX_DEBUG_ASSERT(size > 0);
+		if (sample == nullptr)
+		{
+			return;
+		}
 
-		void* mem = malloc(size);
+		AcquireSRWLockExclusive(&samples_lock);
+
+		if (sample->prev != nullptr)
+		{
+			sample->prev->next = sample->next;
+		}
+		else
+		{
+			samples_list = sample->next;
+		}
 
-		if (mem != nullptr)
+		if (sample->next != nullptr)
 		{
-			return mem;
+			sample->next->prev = sample->prev;
 		}
 
-		out_of_mem();
+		ReleaseSRWLockExclusive(&samples_lock);
+		HeapFree(GetProcessHeap(), 0, sample);
 	}
 
-	void* zalloc_mem(size_t size)
+	static i32_t compare_sites(const void* lhs, const void* rhs)
+	{
+		i64_t lhs_bytes = ((const mem_site_t*)lhs)->live_bytes;
+		i64_t rhs_bytes = ((const mem_site_t*)rhs)->live_bytes;
+		return (lhs_bytes < rhs_bytes) ? 1 : ((lhs_bytes > rhs_bytes) ? -1 : 0);
+	}
+
+	// Returns false without running any handler when called from a handler, or when another thread is already reclaiming and wait is off
+	static bool run_reclaimers(size_t size, bool wait, size_t& reclaimed)
+	{
+		reclaimed = 0;
+
+		// Handlers may allocate while releasing, which must not reclaim again
+		if (mem_reclaiming)
+		{
+			return false;
+		}
+
+		if (wait)
+		{
+			AcquireSRWLockExclusive(&mem_reclaim_lock);
+		}
+		else if (!TryAcquireSRWLockExclusive(&mem_reclaim_lock))
+		{
+			return false;
+		}
+
+		mem_reclaimer_t reclaimers[max_mem_reclaimers];
+		AcquireSRWLockShared(&mem_reclaimers_lock);
+		i32_t count = mem_reclaimer_count;
+		memcpy(reclaimers, mem_reclaimers, sizeof(mem_reclaimer_t) * count);
+		ReleaseSRWLockShared(&mem_reclaimers_lock);
+		mem_reclaiming = true;
+
+		for (i32_t i = 0; (i < count) && (reclaimed < size); ++i)
+		{
+			reclaimed += reclaimers[i].handler(size - reclaimed, reclaimers[i].user_ptr);
+		}
+
+		mem_reclaiming = false;
+		ReleaseSRWLockExclusive(&mem_reclaim_lock);
+		return true;
+	}
+
+	// Allocating threads never wait for a reclaim that is already running elsewhere
+	static size_t try_reclaim_mem(size_t size)
+	{
+		size_t reclaimed;
+		run_reclaimers(size, false, reclaimed);
+		return reclaimed;
+	}
+
+	// Live totals lag behind by the per-thread pending bytes, which is close enough for a budget
+	static void check_mem_budget(size_t size)
+	{
+		i64_t soft_limit = mem_soft_limit;
+		i64_t hard_limit = mem_hard_limit;
+
+		if ((soft_limit == 0) && (hard_limit == 0))
+		{
+			return;
+		}
+
+		i64_t usage = total_live_bytes + (i64_t)size;
+
+		if (soft_limit > 0)
+		{
+			// Crossing the soft limit reclaims once, usage has to fall below the low-water mark before it can happen again
+			if (usage <= soft_limit - soft_limit / 8)
+			{
+				if (mem_reclaim_armed == 0)
+				{
+					InterlockedExchange(&mem_reclaim_armed, 1);
+				}
+			}
+			else if ((usage > soft_limit) && (mem_reclaim_armed != 0) && (InterlockedCompareExchange(&mem_reclaim_armed, 0, 1) == 1))
+			{
+				usage -= (i64_t)try_reclaim_mem((size_t)(usage - soft_limit));
+			}
+		}
+
+		// Handlers are allowed past the hard limit, they usually allocate while releasing more
+		while ((hard_limit > 0) && (usage > hard_limit) && !mem_reclaiming)
+		{
+			size_t reclaimed;
+
+			if (run_reclaimers((size_t)(usage - hard_limit), false, reclaimed))
+			{
+				if (usage - (i64_t)reclaimed > hard_limit)
+				{
+					out_of_mem();
+				}
+
+				break;
+			}
+
+			// Another thread is reclaiming, so wait for it to finish and look at the usage it left behind
+			AcquireSRWLockShared(&mem_reclaim_lock);
+			ReleaseSRWLockShared(&mem_reclaim_lock);
+			usage = total_live_bytes + (i64_t)size;
+		}
+	}
+
+	static void* alloc_backend_mem(size_t size, bool zeroed)
+	{
+		// The first allocation fixes the backend for the rest of the process
+		if (!mem_backend_locked)
+		{
+			mem_backend_locked = true;
+		}
+
+		if (mem_backend == MEM_BACKEND_CACHING)
+		{
+			return internal__alloc_heap(size, zeroed);
+		}
+
+		if (zeroed)
+		{
+			return calloc(1, size);
+		}
+
+		return malloc(size);
+	}
+
+	static void free_backend_mem(void* mem)
+	{
+		if (mem_backend == MEM_BACKEND_CACHING)
+		{
+			internal__free_heap(mem);
+			return;
+		}
+
+		free(mem);
+	}
+
+	static void* alloc_tagged(size_t size, e32_t tag, bool zeroed)
 	{
 		AUX_DEBUG_ASSERT(size > 0);
+		AUX_DEBUG_ASSERT((tag >= 0) && (tag < MEM_TAG_MAX_ENUMS));
+
+		check_mem_budget(size);
+
+		// Sampled blocks keep their sample pointer in an extra header slot in front
+		bool sampled = should_sample(size);
+		size_t header_size = sampled ? mem_header_size * 2 : mem_header_size;
+		u8_t* base = (u8_t*)alloc_backend_mem(size + header_size, zeroed);
 
-		void* mem = malloc(size);
+		if ((base == nullptr) && (try_reclaim_mem(size) > 0))
+		{
+			base = (u8_t*)alloc_backend_mem(size + header_size, zeroed);
+		}
 
-		if (mem != nullptr)
+		if (base != nullptr)
 		{
-			memset(mem, 0, size);
-			return mem;
+			mem_header_t* header = (mem_header_t*)(base + header_size - mem_header_size);
+			header->size = size;
+			header->tag = tag;
+			header->flags = 0;
+
+			if (sampled)
+			{
+				*(mem_sample_t**)base = record_sample(size);
+				header->flags = mem_flag_sampled;
+			}
+
+			count_alloc(tag, size);
+			return base + header_size;
 		}
 
 		out_of_mem();
 	}
 
-	void free_mem(void* mem)
+	static bool is_pow2(size_t value)
 	{
-		AUX_DEBUG_ASSERT(mem != nullptr);
+		return (value != 0) && ((value & (value - 1)) == 0);
+	}
 
-		free(mem);
+	static size_t align_size(size_t size, size_t alignment)
+	{
+		return (size + alignment - 1) & ~(alignment - 1);
 	}
 
-	void copy_mem(const void* mem_src, void* mem_dst, size_t size)
+	static u32_t find_first_bit(u64_t mask)
+	{
+		unsigned long index;
+
+		#if defined(_M_X64)
+		_BitScanForward64(&index, mask);
+		#else
+		if (!_BitScanForward(&index, (unsigned long)mask))
+		{
+			_BitScanForward(&index, (unsigned long)(mask >> 32));
+			index += 32;
+		}
+		#endif
+
+		return (u32_t)index;
+	}
+
+	static u64_t load_u64(const u8_t* mem)
 	{
-		memcpy(mem_dst, mem_src, size);
+		u64_t value;
+		memcpy(&value, mem, sizeof(value));
+		return value;
 	}
 
-	void move_mem(const void* mem_src, void* mem_dst, size_t size)
+	static u32_t load_u32(const u8_t* mem)
 	{
-		memmove(mem_dst, mem_src, size);
+		u32_t value;
+		memcpy(&value, mem, sizeof(value));
+		return value;
 	}
 
-	void fill_mem(void* mem, u8_t value, size_t size)
+	static void store_u64(u8_t* mem, u64_t value)
 	{
-		memset(mem, value, size);
+		memcpy(mem, &value, sizeof(value));
 	}
 
-	void zero_mem(void* mem, size_t size)
+	static void store_u32(u8_t* mem, u32_t value)
 	{
-		memset(mem, 0, size);
+		memcpy(mem, &value, sizeof(value));
 	}
 
-	i32_t compare_mem(const void* mem1, const void* mem2, size_t size)
+	static i32_t diff_bytes(const u8_t* mem1, const u8_t* mem2, size_t offset)
+	{
+		return (i32_t)mem1[offset] - (i32_t)mem2[offset];
+	}
+
+	// Sizes up to 16 bytes are handled with two overlapping scalar moves
+	static void copy_small(const u8_t* src, u8_t* dst, size_t size)
 	{
-		return (i32_t)memcmp(mem1, mem2, size);
+		if (size >= 8)
+		{
+			u64_t head = load_u64(src);
+			u64_t tail = load_u64(src + size - 8);
+			store_u64(dst, head);
+			store_u64(dst + size - 8, tail);
+		}
+		else if (size >= 4)
+		{
+			u32_t head = load_u32(src);
+			u32_t tail = load_u32(src + size - 4);
+			store_u32(dst, head);
+			store_u32(dst + size - 4, tail);
+		}
+		else
+		{
+			for (size_t i = 0; i < size; ++i)
+			{
+				dst[i] = src[i];
+			}
+		}
+	}
+
+	static void fill_small(u8_t* mem, u8_t value, size_t size)
+	{
+		u64_t pattern = (u64_t)value * 0x0101010101010101ull;
+
+		if (size >= 8)
+		{
+			store_u64(mem, pattern);
+			store_u64(mem + size - 8, pattern);
+		}
+		else if (size >= 4)
+		{
+			store_u32(mem, (u32_t)pattern);
+			store_u32(mem + size - 4, (u32_t)pattern);
+		}
+		else
+		{
+			for (size_t i = 0; i < size; ++i)
+			{
+				mem[i] = value;
+			}
+		}
+	}
+
+	static i32_t compare_small(const u8_t* mem1, const u8_t* mem2, size_t size)
+	{
+		if (size >= 8)
+		{
+			u64_t diff = load_u64(mem1) ^ load_u64(mem2);
+
+			if (diff != 0)
+			{
+				return diff_bytes(mem1, mem2, find_first_bit(diff) / 8);
+			}
+
+			size_t offset = size - 8;
+			diff = load_u64(mem1 + offset) ^ load_u64(mem2 + offset);
+
+			if (diff != 0)
+			{
+				return diff_bytes(mem1, mem2, offset + find_first_bit(diff) / 8);
+			}
+
+			return 0;
+		}
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			if (mem1[i] != mem2[i])
+			{
+				return diff_bytes(mem1, mem2, i);
+			}
+		}
+
+		return 0;
+	}
+
+	// The narrowest width has no half, sizes below it go to the scalar small paths instead
+	struct simd_sse2_t
+	{
+		typedef simd_sse2_t half_t;
+		typedef __m128i vec_t;
+		static const size_t width = 16;
+
+		static vec_t load(const u8_t* mem)
+		{
+			return _mm_loadu_si128((const __m128i*)mem);
+		}
+
+		static void store(u8_t* mem, vec_t value)
+		{
+			_mm_storeu_si128((__m128i*)mem, value);
+		}
+
+		static void stream(u8_t* mem, vec_t value)
+		{
+			_mm_stream_si128((__m128i*)mem, value);
+		}
+
+		static vec_t broadcast(u8_t value)
+		{
+			return _mm_set1_epi8((char)value);
+		}
+
+		static u64_t get_diff_mask(const u8_t* mem1, const u8_t* mem2)
+		{
+			return (u64_t)(~_mm_movemask_epi8(_mm_cmpeq_epi8(load(mem1), load(mem2))) & 0xffff);
+		}
+
+		static void finish()
+		{
+		}
+	};
+
+	struct simd_avx2_t
+	{
+		typedef simd_sse2_t half_t;
+		typedef __m256i vec_t;
+		static const size_t width = 32;
+
+		static vec_t load(const u8_t* mem)
+		{
+			return _mm256_loadu_si256((const __m256i*)mem);
+		}
+
+		static void store(u8_t* mem, vec_t value)
+		{
+			_mm256_storeu_si256((__m256i*)mem, value);
+		}
+
+		static void stream(u8_t* mem, vec_t value)
+		{
+			_mm256_stream_si256((__m256i*)mem, value);
+		}
+
+		static vec_t broadcast(u8_t value)
+		{
+			return _mm256_set1_epi8((char)value);
+		}
+
+		static u64_t get_diff_mask(const u8_t* mem1, const u8_t* mem2)
+		{
+			return (u64_t)(u32_t)~_mm256_movemask_epi8(_mm256_cmpeq_epi8(load(mem1), load(mem2)));
+		}
+
+		static void finish()
+		{
+			_mm256_zeroupper();
+		}
+	};
+
+	struct simd_avx512_t
+	{
+		typedef simd_avx2_t half_t;
+		typedef __m512i vec_t;
+		static const size_t width = 64;
+
+		static vec_t load(const u8_t* mem)
+		{
+			return _mm512_loadu_si512((const void*)mem);
+		}
+
+		static void store(u8_t* mem, vec_t value)
+		{
+			_mm512_storeu_si512((void*)mem, value);
+		}
+
+		static void stream(u8_t* mem, vec_t value)
+		{
+			_mm512_stream_si512((__m512i*)mem, value);
+		}
+
+		static vec_t broadcast(u8_t value)
+		{
+			return _mm512_set1_epi8((char)value);
+		}
+
+		static u64_t get_diff_mask(const u8_t* mem1, const u8_t* mem2)
+		{
+			return (u64_t)_mm512_cmpneq_epi8_mask(load(mem1), load(mem2));
+		}
+
+		static void finish()
+		{
+			_mm256_zeroupper();
+		}
+	};
+
+	static_assert(small_copy_size >= simd_sse2_t::width, "Sizes below the narrowest vector must fit the small paths");
+
+	template<typename T>
+	static void stream_copy(const u8_t* src, u8_t* dst, size_t size)
+	{
+		// Align the destination so that every streaming store writes whole lines
+		size_t head = (T::width - ((size_t)dst & (T::width - 1))) & (T::width - 1);
+		T::store(dst, T::load(src));
+		src += head;
+		dst += head;
+		size -= head;
+
+		while (size >= T::width * 4)
+		{
+			T::stream(dst, T::load(src));
+			T::stream(dst + T::width, T::load(src + T::width));
+			T::stream(dst + T::width * 2, T::load(src + T::width * 2));
+			T::stream(dst + T::width * 3, T::load(src + T::width * 3));
+			src += T::width * 4;
+			dst += T::width * 4;
+			size -= T::width * 4;
+		}
+
+		while (size >= T::width)
+		{
+			T::stream(dst, T::load(src));
+			src += T::width;
+			dst += T::width;
+			size -= T::width;
+		}
+
+		_mm_sfence();
+
+		if (size > 0)
+		{
+			T::store(dst + size - T::width, T::load(src + size - T::width));
+		}
+	}
+
+	template<typename T>
+	static void stream_fill(u8_t* mem, u8_t value, size_t size)
+	{
+		typename T::vec_t pattern = T::broadcast(value);
+		size_t head = (T::width - ((size_t)mem & (T::width - 1))) & (T::width - 1);
+		T::store(mem, pattern);
+		mem += head;
+		size -= head;
+
+		while (size >= T::width)
+		{
+			T::stream(mem, pattern);
+			mem += T::width;
+			size -= T::width;
+		}
+
+		_mm_sfence();
+
+		if (size > 0)
+		{
+			T::store(mem + size - T::width, pattern);
+		}
+	}
+
+	template<typename T>
+	static void copy_simd(const void* mem_src, void* mem_dst, size_t size)
+	{
+		if (size < T::width)
+		{
+			if (T::width <= small_copy_size)
+			{
+				copy_small((const u8_t*)mem_src, (u8_t*)mem_dst, size);
+				return;
+			}
+
+			copy_simd<typename T::half_t>(mem_src, mem_dst, size);
+			return;
+		}
+
+		const u8_t* src = (const u8_t*)mem_src;
+		u8_t* dst = (u8_t*)mem_dst;
+
+		if (size >= mem_stream_threshold)
+		{
+			stream_copy<T>(src, dst, size);
+			T::finish();
+			return;
+		}
+
+		typename T::vec_t tail = T::load(src + size - T::width);
+		u8_t* dst_tail = dst + size - T::width;
+
+		while (size > T::width)
+		{
+			T::store(dst, T::load(src));
+			src += T::width;
+			dst += T::width;
+			size -= T::width;
+		}
+
+		T::store(dst_tail, tail);
+		T::finish();
+	}
+
+	template<typename T>
+	static void fill_simd(void* mem, u8_t value, size_t size)
+	{
+		if (size < T::width)
+		{
+			if (T::width <= small_copy_size)
+			{
+				fill_small((u8_t*)mem, value, size);
+				return;
+			}
+
+			fill_simd<typename T::half_t>(mem, value, size);
+			return;
+		}
+
+		u8_t* dst = (u8_t*)mem;
+
+		if (size >= mem_stream_threshold)
+		{
+			stream_fill<T>(dst, value, size);
+			T::finish();
+			return;
+		}
+
+		typename T::vec_t pattern = T::broadcast(value);
+		T::store(dst + size - T::width, pattern);
+
+		while (size > T::width)
+		{
+			T::store(dst, pattern);
+			dst += T::width;
+			size -= T::width;
+		}
+
+		T::finish();
+	}
+
+	template<typename T>
+	static i32_t compare_simd(const void* mem1, const void* mem2, size_t size)
+	{
+		if (size < T::width)
+		{
+			if (T::width <= small_copy_size)
+			{
+				return compare_small((const u8_t*)mem1, (const u8_t*)mem2, size);
+			}
+
+			return compare_simd<typename T::half_t>(mem1, mem2, size);
+		}
+
+		const u8_t* lhs = (const u8_t*)mem1;
+		const u8_t* rhs = (const u8_t*)mem2;
+		size_t pos = 0;
+
+		for (;;)
+		{
+			if (pos + T::width > size)
+			{
+				// Recheck the overlapping tail block
+				pos = size - T::width;
+			}
+
+			u64_t mask = T::get_diff_mask(lhs + pos, rhs + pos);
+
+			if (mask != 0)
+			{
+				T::finish();
+				return diff_bytes(lhs, rhs, pos + find_first_bit(mask));
+			}
+
+			pos += T::width;
+
+			if (pos >= size)
+			{
+				break;
+			}
+		}
+
+		T::finish();
+		return 0;
+	}
+
+	static void detect_simd();
+
+	static void copy_detect(const void* mem_src, void* mem_dst, size_t size)
+	{
+		detect_simd();
+		copy_mem(mem_src, mem_dst, size);
+	}
+
+	static void fill_detect(void* mem, u8_t value, size_t size)
+	{
+		detect_simd();
+		fill_mem(mem, value, size);
+	}
+
+	static i32_t compare_detect(const void* mem1, const void* mem2, size_t size)
+	{
+		detect_simd();
+		return compare_mem(mem1, mem2, size);
+	}
+
+	static void(*copy_func)(const void* mem_src, void* mem_dst, size_t size) = &copy_detect;
+	static void(*fill_func)(void* mem, u8_t value, size_t size) = &fill_detect;
+	static i32_t(*compare_func)(const void* mem1, const void* mem2, size_t size) = &compare_detect;
+
+	static LONG detect_cpu_features()
+	{
+		i32_t regs[4];
+		__cpuid(regs, 0);
+		i32_t max_leaf = regs[0];
+		__cpuid(regs, 1);
+		bool os_avx = ((regs[2] & (1 << 27)) != 0) && ((regs[2] & (1 << 28)) != 0);
+		LONG features = 0;
+
+		if (os_avx && (max_leaf >= 7))
+		{
+			// The OS must save the upper register state for the wider paths to be usable
+			u64_t xcr0 = _xgetbv(0);
+			__cpuidex(regs, 7, 0);
+
+			if (((xcr0 & 0x6) == 0x6) && ((regs[1] & (1 << 5)) != 0))
+			{
+				features |= 1 << CPU_FEATURE_AVX2;
+			}
+
+			if (((xcr0 & 0xe6) == 0xe6) && ((regs[1] & (1 << 16)) != 0) && ((regs[1] & (1 << 30)) != 0))
+			{
+				features |= 1 << CPU_FEATURE_AVX512;
+			}
+		}
+
+		return features;
+	}
+
+	static void detect_simd()
+	{
+		if (has_cpu_feature(CPU_FEATURE_AVX512))
+		{
+			compare_func = &compare_simd<simd_avx512_t>;
+			fill_func = &fill_simd<simd_avx512_t>;
+			copy_func = &copy_simd<simd_avx512_t>;
+		}
+		else if (has_cpu_feature(CPU_FEATURE_AVX2))
+		{
+			compare_func = &compare_simd<simd_avx2_t>;
+			fill_func = &fill_simd<simd_avx2_t>;
+			copy_func = &copy_simd<simd_avx2_t>;
+		}
+		else
+		{
+			compare_func = &compare_simd<simd_sse2_t>;
+			fill_func = &fill_simd<simd_sse2_t>;
+			copy_func = &copy_simd<simd_sse2_t>;
+		}
+	}
+
+	static void* alloc_aligned(size_t size, size_t alignment, e32_t tag, bool zeroed)
+	{
+		AUX_DEBUG_ASSERT(is_pow2(alignment));
+
+		// The original block pointer is stored right below the aligned one
+		alignment = max_of(alignment, mem_header_size);
+		u8_t* mem = (u8_t*)alloc_tagged(size + alignment, tag, zeroed);
+		u8_t* aligned = (u8_t*)align_size((size_t)mem + sizeof(void*), alignment);
+		((void**)aligned)[-1] = mem;
+		return aligned;
+	}
+
+	static bool enable_lock_memory_privilege()
+	{
+		HANDLE token;
+
+		if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+		{
+			return false;
+		}
+
+		TOKEN_PRIVILEGES privileges = {};
+		privileges.PrivilegeCount = 1;
+		privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+		bool enabled = false;
+
+		if (LookupPrivilegeValueW(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid))
+		{
+			// Succeeds even when the privilege is not held, so the error code must be checked too
+			enabled = AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) && (GetLastError() == ERROR_SUCCESS);
+		}
+
+		CloseHandle(token);
+		return enabled;
+	}
+
+	static size_t get_large_page_size()
+	{
+		switch (large_pages_state)
+		{
+			case 1:
+				return large_page_size;
+			case 2:
+				return 0;
+		}
+
+		large_page_size = GetLargePageMinimum();
+		bool available = (large_page_size != 0) && enable_lock_memory_privilege();
+		InterlockedExchange(&large_pages_state, available ? 1 : 2);
+		return available ? large_page_size : 0;
+	}
+
+	// Pages are placed on the preferred node when first touched
+	static void* map_pages(size_t size, DWORD flags, DWORD node)
+	{
+		if (node == NUMA_NO_PREFERRED_NODE)
+		{
+			return VirtualAlloc(nullptr, size, flags, PAGE_READWRITE);
+		}
+
+		return VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, flags, PAGE_READWRITE, node);
+	}
+
+	static void* alloc_huge(size_t size, e32_t tag, DWORD node)
+	{
+		AUX_DEBUG_ASSERT(size > 0);
+		AUX_DEBUG_ASSERT((tag >= 0) && (tag < MEM_TAG_MAX_ENUMS));
+
+		check_mem_budget(size);
+		size_t mapped_size = size + huge_header_size;
+		size_t page_size = get_large_page_size();
+		void* base = nullptr;
+		bool backed = false;
+
+		if ((page_size != 0) && (mapped_size >= page_size))
+		{
+			// Large pages are only granted while enough physical memory is contiguous, so fall back quietly
+			size_t large_size = align_size(mapped_size, page_size);
+			base = map_pages(large_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, node);
+
+			if (base != nullptr)
+			{
+				mapped_size = large_size;
+				backed = true;
+			}
+		}
+
+		if (base == nullptr)
+		{
+			base = map_pages(mapped_size, MEM_RESERVE | MEM_COMMIT, node);
+
+			if ((base == nullptr) && (try_reclaim_mem(mapped_size) > 0))
+			{
+				base = map_pages(mapped_size, MEM_RESERVE | MEM_COMMIT, node);
+			}
+
+			if (base == nullptr)
+			{
+				out_of_mem();
+			}
+		}
+
+		huge_header_t* header = (huge_header_t*)base;
+		header->size = size;
+		header->mapped_size = mapped_size;
+		header->tag = tag;
+		header->backed = backed;
+		count_alloc(tag, size);
+		InterlockedExchangeAdd64(&huge_live_bytes, (LONG64)mapped_size);
+
+		if (backed)
+		{
+			InterlockedExchangeAdd64(&huge_backed_bytes, (LONG64)mapped_size);
+		}
+
+		return (u8_t*)base + huge_header_size;
+	}
+
+	static u8_t* reserve_pages(size_t capacity)
+	{
+		void* base = VirtualAlloc(nullptr, capacity, MEM_RESERVE, PAGE_NOACCESS);
+
+		if (base == nullptr)
+		{
+			out_of_mem();
+		}
+
+		return (u8_t*)base;
+	}
+
+	static size_t commit_pages(u8_t* base, size_t committed, size_t capacity, size_t size, e32_t tag)
+	{
+		if (size > capacity)
+		{
+			out_of_mem();
+		}
+
+		size_t new_committed = min_of(align_size(size, vm_commit_size), capacity);
+		check_mem_budget(new_committed - committed);
+
+		if (VirtualAlloc(base + committed, new_committed - committed, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+		{
+			if ((try_reclaim_mem(new_committed - committed) == 0) || (VirtualAlloc(base + committed, new_committed - committed, MEM_COMMIT, PAGE_READWRITE) == nullptr))
+			{
+				out_of_mem();
+			}
+		}
+
+		add_live_bytes(tag, (i64_t)(new_committed - committed));
+		return new_committed;
+	}
+
+	static size_t decommit_pages(u8_t* base, size_t committed, size_t size, e32_t tag)
+	{
+		size_t new_committed = align_size(size, vm_commit_size);
+
+		if (new_committed < committed)
+		{
+			VirtualFree(base + new_committed, committed - new_committed, MEM_DECOMMIT);
+			add_live_bytes(tag, -(i64_t)(committed - new_committed));
+			return new_committed;
+		}
+
+		return committed;
+	}
+
+	static void* carve_slab_item(slab_pool_t* pool, size_t item_size)
+	{
+		AcquireSRWLockExclusive(&pool->lock);
+
+		if ((pool->slabs == nullptr) || (pool->slab_pos + item_size > slab_size))
+		{
+			u8_t* slab = (u8_t*)VirtualAlloc(nullptr, slab_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+			if (slab == nullptr)
+			{
+				ReleaseSRWLockExclusive(&pool->lock);
+
+				if (try_reclaim_mem(slab_size) == 0)
+				{
+					out_of_mem();
+				}
+
+				return carve_slab_item(pool, item_size);
+			}
+
+			// Slabs are chained through their headers
+			add_live_bytes(MEM_TAG_POOL, (i64_t)slab_size);
+			*(u8_t**)slab = pool->slabs;
+			pool->slabs = slab;
+			pool->slab_pos = slab_header_size;
+		}
+
+		void* item = pool->slabs + pool->slab_pos;
+		pool->slab_pos += item_size;
+		ReleaseSRWLockExclusive(&pool->lock);
+		return item;
+	}
+
+	static void* pop_slab_item(slab_pool_t* pool, size_t item_size)
+	{
+		void* item = InterlockedPopEntrySList(&pool->free_items);
+
+		if (item != nullptr)
+		{
+			return item;
+		}
+
+		return carve_slab_item(pool, item_size);
+	}
+
+	static void push_slab_item(slab_pool_t* pool, void* item)
+	{
+		InterlockedPushEntrySList(&pool->free_items, (PSLIST_ENTRY)item);
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Debug functions
+	//
+	///////////////////////////////////////////////////////////
+
+	#if defined(AUX_DEBUG_ON)
+
+	void report_debug_error__SHOULD_NOT_BE_USED_DIRECTLY(const wchar_t message[])
+	{
+		MessageBoxW(GetForegroundWindow(), message, L"DEBUG ERROR", MB_TOPMOST | MB_TASKMODAL | MB_ICONERROR | MB_OK);
+		DebugBreak();
+	}
+
+	void begin_debug_memory_guard__SHOULD_NOT_BE_USED_DIRECTLY()
+	{
+		_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+	}
+
+	void end_debug_memory_guard__SHOULD_NOT_BE_USED_DIRECTLY()
+	{
+		_CrtDumpMemoryLeaks();
+	}
+
+	#endif
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Math functions
+	//
+	///////////////////////////////////////////////////////////
+
+	template<>
+	f32_t min_of<f32_t>(f32_t lhs, f32_t rhs)
+	{
+		return fminf(lhs, rhs);
+	}
+
+	template<>
+	f64_t min_of<f64_t>(f64_t lhs, f64_t rhs)
+	{
+		return fmin(lhs, rhs);
+	}
+
+	template<>
+	f32_t max_of<f32_t>(f32_t lhs, f32_t rhs)
+	{
+		return fmaxf(lhs, rhs);
+	}
+
+	template<>
+	f64_t max_of<f64_t>(f64_t lhs, f64_t rhs)
+	{
+		return fmax(lhs, rhs);
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	CPU functions
+	//
+	///////////////////////////////////////////////////////////
+
+	bool has_cpu_feature(e32_t feature)
+	{
+		AUX_DEBUG_ASSERT((feature >= 0) && (feature < CPU_FEATURE_MAX_ENUMS));
+
+		// Racing threads detect the same value, so the store needs no ordering
+		LONG features = cpu_features;
+
+		if (features < 0)
+		{
+			features = detect_cpu_features();
+			cpu_features = features;
+		}
+
+		return (features & (1 << feature)) != 0;
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Memory functions
+	//
+	///////////////////////////////////////////////////////////
+
+	e32_t get_mem_backend()
+	{
+		return mem_backend;
+	}
+
+	bool select_mem_backend(e32_t backend)
+	{
+		if (mem_backend_locked)
+		{
+			return backend == mem_backend;
+		}
+
+		switch (backend)
+		{
+			case MEM_BACKEND_SYSTEM:
+				break;
+			case MEM_BACKEND_CACHING:
+				if (!internal__init_heap())
+				{
+					return false;
+				}
+				break;
+			default:
+				return false;
+		}
+
+		mem_backend = backend;
+		return true;
+	}
+
+	void get_mem_stats(mem_stats_t& stats)
+	{
+		zero_mem(&stats, sizeof(stats));
+		AcquireSRWLockShared(&counters_lock);
+
+		for (i32_t i = 0; i < MEM_TAG_MAX_ENUMS; ++i)
+		{
+			mem_tag_stats_t& tag = stats.tags[i];
+			tag.live_bytes = live_bytes[i];
+			tag.alloc_count = retired_counters.alloc_counts[i];
+
+			for (i32_t j = 0; j < mem_histogram_size; ++j)
+			{
+				tag.histogram[j] = retired_counters.histograms[i][j];
+			}
+
+			for (const mem_counters_t* counters = counters_list; counters != nullptr; counters = counters->next)
+			{
+				tag.live_bytes += counters->pending_bytes[i];
+				tag.alloc_count += counters->alloc_counts[i];
+
+				for (i32_t j = 0; j < mem_histogram_size; ++j)
+				{
+					tag.histogram[j] += counters->histograms[i][j];
+				}
+			}
+
+			tag.peak_bytes = max_of<i64_t>(peak_bytes[i], tag.live_bytes);
+			stats.live_bytes += tag.live_bytes;
+		}
+
+		ReleaseSRWLockShared(&counters_lock);
+		stats.peak_bytes = max_of<i64_t>(total_peak_bytes, stats.live_bytes);
+		stats.huge_live_bytes = huge_live_bytes;
+		stats.huge_backed_bytes = huge_backed_bytes;
+	}
+
+	size_t get_mem_sample_interval()
+	{
+		return (size_t)mem_sample_interval;
+	}
+
+	void set_mem_sample_interval(size_t size)
+	{
+		InterlockedExchange64(&mem_sample_interval, (LONG64)size);
+	}
+
+	u32_t get_mem_sites(mem_site_t sites[], u32_t max_sites)
+	{
+		AcquireSRWLockShared(&samples_lock);
+		u32_t sample_count = 0;
+
+		for (const mem_sample_t* sample = samples_list; sample != nullptr; sample = sample->next)
+		{
+			++sample_count;
+		}
+
+		mem_site_t* groups = (sample_count > 0) ? (mem_site_t*)HeapAlloc(GetProcessHeap(), 0, sizeof(mem_site_t) * sample_count) : nullptr;
+		u32_t* hashes = (sample_count > 0) ? (u32_t*)HeapAlloc(GetProcessHeap(), 0, sizeof(u32_t) * sample_count) : nullptr;
+		u32_t group_count = 0;
+
+		if ((groups != nullptr) && (hashes != nullptr))
+		{
+			for (const mem_sample_t* sample = samples_list; sample != nullptr; sample = sample->next)
+			{
+				u32_t index = 0;
+
+				while ((index < group_count) && ((hashes[index] != sample->hash) || (groups[index].frame_count != sample->frame_count)))
+				{
+					++index;
+				}
+
+				if (index == group_count)
+				{
+					mem_site_t& site = groups[group_count++];
+					site.live_bytes = 0;
+					site.sample_count = 0;
+					site.frame_count = sample->frame_count;
+					memcpy(site.frames, sample->frames, sizeof(void*) * sample->frame_count);
+					hashes[index] = sample->hash;
+				}
+
+				groups[index].live_bytes += sample->weight;
+				++groups[index].sample_count;
+			}
+		}
+
+		ReleaseSRWLockShared(&samples_lock);
+		qsort(groups, group_count, sizeof(mem_site_t), (int(*)(const void*, const void*))&compare_sites);
+		u32_t count = min_of(group_count, max_sites);
+		memcpy(sites, groups, sizeof(mem_site_t) * count);
+
+		if (groups != nullptr)
+		{
+			HeapFree(GetProcessHeap(), 0, groups);
+		}
+
+		if (hashes != nullptr)
+		{
+			HeapFree(GetProcessHeap(), 0, hashes);
+		}
+
+		return count;
+	}
+
+	void report_mem_sites(u32_t max_sites)
+	{
+		mem_site_t* sites = (mem_site_t*)HeapAlloc(GetProcessHeap(), 0, sizeof(mem_site_t) * max_of<u32_t>(max_sites, 1));
+
+		if (sites == nullptr)
+		{
+			return;
+		}
+
+		u32_t count = get_mem_sites(sites, max_sites);
+		char line[MAX_PATH + 64];
+
+		for (u32_t i = 0; i < count; ++i)
+		{
+			snprintf(line, sizeof(line), "%lld bytes in %llu samples\n", (long long)sites[i].live_bytes, (unsigned long long)sites[i].sample_count);
+			OutputDebugStringA(line);
+
+			// Frames are printed relative to their module so they can be symbolized offline
+			for (u32_t j = 0; j < sites[i].frame_count; ++j)
+			{
+				HMODULE module = nullptr;
+				char path[MAX_PATH] = "?";
+				size_t offset = (size_t)sites[i].frames[j];
+
+				if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCWSTR)sites[i].frames[j], &module))
+				{
+					GetModuleFileNameA(module, path, MAX_PATH);
+					offset -= (size_t)module;
+				}
+
+				snprintf(line, sizeof(line), "    %s+0x%zx\n", path, offset);
+				OutputDebugStringA(line);
+			}
+		}
+
+		HeapFree(GetProcessHeap(), 0, sites);
+	}
+
+	void set_mem_budget(size_t soft_limit, size_t hard_limit)
+	{
+		AUX_DEBUG_ASSERT((hard_limit == 0) || (soft_limit <= hard_limit));
+
+		InterlockedExchange64(&mem_soft_limit, (LONG64)soft_limit);
+		InterlockedExchange64(&mem_hard_limit, (LONG64)hard_limit);
+		InterlockedExchange(&mem_reclaim_armed, 1);
+	}
+
+	bool add_mem_reclaimer(mem_reclaim_handler_t handler, void* user_ptr, i32_t priority)
+	{
+		AUX_DEBUG_ASSERT(handler != nullptr);
+
+		AcquireSRWLockExclusive(&mem_reclaimers_lock);
+
+		if (mem_reclaimer_count == max_mem_reclaimers)
+		{
+			ReleaseSRWLockExclusive(&mem_reclaimers_lock);
+			return false;
+		}
+
+		// Kept sorted so lower priorities are asked to give memory back first
+		i32_t index = mem_reclaimer_count++;
+
+		while ((index > 0) && (mem_reclaimers[index - 1].priority > priority))
+		{
+			mem_reclaimers[index] = mem_reclaimers[index - 1];
+			--index;
+		}
+
+		mem_reclaimers[index].handler = handler;
+		mem_reclaimers[index].user_ptr = user_ptr;
+		mem_reclaimers[index].priority = priority;
+		ReleaseSRWLockExclusive(&mem_reclaimers_lock);
+		return true;
+	}
+
+	void remove_mem_reclaimer(mem_reclaim_handler_t handler, void* user_ptr)
+	{
+		AcquireSRWLockExclusive(&mem_reclaimers_lock);
+
+		for (i32_t i = 0; i < mem_reclaimer_count; ++i)
+		{
+			if ((mem_reclaimers[i].handler == handler) && (mem_reclaimers[i].user_ptr == user_ptr))
+			{
+				--mem_reclaimer_count;
+
+				for (i32_t j = i; j < mem_reclaimer_count; ++j)
+				{
+					mem_reclaimers[j] = mem_reclaimers[j + 1];
+				}
+
+				break;
+			}
+		}
+
+		ReleaseSRWLockExclusive(&mem_reclaimers_lock);
+	}
+
+	size_t reclaim_mem(size_t size)
+	{
+		size_t reclaimed;
+		run_reclaimers(size, true, reclaimed);
+		return reclaimed;
+	}
+
+	void* alloc_mem(size_t size)
+	{
+		return alloc_tagged(size, MEM_TAG_GENERAL, false);
+	}
+
+	void* zalloc_mem(size_t size)
+	{
+		return alloc_tagged(size, MEM_TAG_GENERAL, true);
+	}
+
+	void* alloc_mem_tagged(size_t size, e32_t tag)
+	{
+		return alloc_tagged(size, tag, false);
+	}
+
+	void* zalloc_mem_tagged(size_t size, e32_t tag)
+	{
+		return alloc_tagged(size, tag, true);
+	}
+
+	void free_mem(void* mem)
+	{
+		AUX_DEBUG_ASSERT(mem != nullptr);
+
+		mem_header_t* header = (mem_header_t*)((u8_t*)mem - mem_header_size);
+		count_free(header->tag, (size_t)header->size);
+
+		if (header->flags & mem_flag_sampled)
+		{
+			u8_t* base = (u8_t*)header - mem_header_size;
+			release_sample(*(mem_sample_t**)base);
+			free_backend_mem(base);
+			return;
+		}
+
+		free_backend_mem(header);
+	}
+
+	void* alloc_mem_huge(size_t size, e32_t tag)
+	{
+		return alloc_huge(size, tag, NUMA_NO_PREFERRED_NODE);
+	}
+
+	u32_t get_numa_node_count()
+	{
+		if (numa_node_count == 0)
+		{
+			ULONG highest = 0;
+			numa_node_count = GetNumaHighestNodeNumber(&highest) ? (u32_t)highest + 1 : 1;
+		}
+
+		return numa_node_count;
+	}
+
+	i32_t get_thread_numa_node()
+	{
+		if (thread_numa_node >= 0)
+		{
+			return thread_numa_node;
+		}
+
+		PROCESSOR_NUMBER processor;
+		GetCurrentProcessorNumberEx(&processor);
+		USHORT node;
+		return GetNumaProcessorNodeEx(&processor, &node) ? (i32_t)node : 0;
+	}
+
+	void set_thread_numa_node(i32_t node)
+	{
+		AUX_DEBUG_ASSERT(node < (i32_t)get_numa_node_count());
+
+		thread_numa_node = node;
+	}
+
+	void* alloc_mem_huge_on_node(size_t size, i32_t node, e32_t tag)
+	{
+		// Single node machines skip the placement request entirely
+		if (get_numa_node_count() == 1)
+		{
+			return alloc_huge(size, tag, NUMA_NO_PREFERRED_NODE);
+		}
+
+		if (node < 0)
+		{
+			node = get_thread_numa_node();
+		}
+
+		return alloc_huge(size, tag, ((u32_t)node < numa_node_count) ? (DWORD)node : NUMA_NO_PREFERRED_NODE);
+	}
+
+	void free_mem_huge(void* mem)
+	{
+		AUX_DEBUG_ASSERT(mem != nullptr);
+
+		huge_header_t* header = (huge_header_t*)((u8_t*)mem - huge_header_size);
+		count_free(header->tag, (size_t)header->size);
+		InterlockedExchangeAdd64(&huge_live_bytes, -(LONG64)header->mapped_size);
+
+		if (header->backed)
+		{
+			InterlockedExchangeAdd64(&huge_backed_bytes, -(LONG64)header->mapped_size);
+		}
+
+		VirtualFree(header, 0, MEM_RELEASE);
+	}
+
+	void* alloc_mem_aligned(size_t size, size_t alignment, e32_t tag)
+	{
+		return alloc_aligned(size, alignment, tag, false);
+	}
+
+	void* zalloc_mem_aligned(size_t size, size_t alignment, e32_t tag)
+	{
+		return alloc_aligned(size, alignment, tag, true);
+	}
+
+	void free_mem_aligned(void* mem)
+	{
+		AUX_DEBUG_ASSERT(mem != nullptr);
+
+		free_mem(((void**)mem)[-1]);
+	}
+
+	size_t get_mem_stream_threshold()
+	{
+		return mem_stream_threshold;
+	}
+
+	void set_mem_stream_threshold(size_t size)
+	{
+		mem_stream_threshold = max_of<size_t>(size, cache_line_size * 4);
+	}
+
+	void copy_mem(const void* mem_src, void* mem_dst, size_t size)
+	{
+		if (size <= small_copy_size)
+		{
+			copy_small((const u8_t*)mem_src, (u8_t*)mem_dst, size);
+			return;
+		}
+
+		copy_func(mem_src, mem_dst, size);
+	}
+
+	void move_mem(const void* mem_src, void* mem_dst, size_t size)
+	{
+		memmove(mem_dst, mem_src, size);
+	}
+
+	void fill_mem(void* mem, u8_t value, size_t size)
+	{
+		if (size <= small_copy_size)
+		{
+			fill_small((u8_t*)mem, value, size);
+			return;
+		}
+
+		fill_func(mem, value, size);
+	}
+
+	void zero_mem(void* mem, size_t size)
+	{
+		fill_mem(mem, 0, size);
+	}
+
+	i32_t compare_mem(const void* mem1, const void* mem2, size_t size)
+	{
+		if (size <= small_copy_size)
+		{
+			return compare_small((const u8_t*)mem1, (const u8_t*)mem2, size);
+		}
+
+		return compare_func(mem1, mem2, size);
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Arena functions
+	//
+	///////////////////////////////////////////////////////////
+
+	arena_t* create_arena(size_t capacity)
+	{
+		AUX_DEBUG_ASSERT(capacity > 0);
+
+		capacity = align_size(capacity, vm_commit_size);
+		arena_t* arena = (arena_t*)zalloc_mem_tagged(sizeof(arena_t), MEM_TAG_ARENA);
+		arena->base = reserve_pages(capacity);
+		arena->capacity = capacity;
+		return arena;
+	}
+
+	void destroy_arena(arena_t* arena)
+	{
+		VirtualFree(arena->base, 0, MEM_RELEASE);
+		add_live_bytes(MEM_TAG_ARENA, -(i64_t)arena->committed);
+		free_mem(arena);
+	}
+
+	void* push_arena(arena_t* arena, size_t size)
+	{
+		return push_arena_aligned(arena, size, arena_alignment);
+	}
+
+	void* push_arena_zeroed(arena_t* arena, size_t size)
+	{
+		// Pages above the dirty mark were never handed out, so they are still zero
+		size_t dirty = arena->dirty;
+		u8_t* mem = (u8_t*)push_arena_aligned(arena, size, arena_alignment);
+		size_t start = (size_t)(mem - arena->base);
+
+		if (start < dirty)
+		{
+			memset(mem, 0, min_of(size, dirty - start));
+		}
+
+		return mem;
+	}
+
+	void* push_arena_aligned(arena_t* arena, size_t size, size_t alignment)
+	{
+		AUX_DEBUG_ASSERT(size > 0);
+		AUX_DEBUG_ASSERT(is_pow2(alignment));
+
+		size_t start = align_size((size_t)arena->base + arena->pos, alignment) - (size_t)arena->base;
+		size_t end = start + size;
+
+		if (end > arena->committed)
+		{
+			arena->committed = commit_pages(arena->base, arena->committed, arena->capacity, end, MEM_TAG_ARENA);
+		}
+
+		arena->pos = end;
+
+		if (end > arena->dirty)
+		{
+			arena->dirty = end;
+		}
+
+		return arena->base + start;
+	}
+
+	size_t get_arena_marker(const arena_t* arena)
+	{
+		return arena->pos;
+	}
+
+	void rewind_arena(arena_t* arena, size_t marker)
+	{
+		AUX_DEBUG_ASSERT(marker <= arena->pos);
+
+		arena->pos = marker;
+	}
+
+	void reset_arena(arena_t* arena)
+	{
+		arena->pos = 0;
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	VM buffer functions
+	//
+	///////////////////////////////////////////////////////////
+
+	vm_buffer_t* create_vm_buffer(size_t capacity, e32_t tag)
+	{
+		AUX_DEBUG_ASSERT(capacity > 0);
+		AUX_DEBUG_ASSERT((tag >= 0) && (tag < MEM_TAG_MAX_ENUMS));
+
+		capacity = align_size(capacity, vm_commit_size);
+		vm_buffer_t* buffer = (vm_buffer_t*)zalloc_mem_tagged(sizeof(vm_buffer_t), tag);
+		buffer->base = reserve_pages(capacity);
+		buffer->capacity = capacity;
+		buffer->tag = tag;
+		return buffer;
+	}
+
+	void destroy_vm_buffer(vm_buffer_t* buffer)
+	{
+		VirtualFree(buffer->base, 0, MEM_RELEASE);
+		add_live_bytes(buffer->tag, -(i64_t)buffer->committed);
+		free_mem(buffer);
+	}
+
+	void* get_vm_buffer_data(const vm_buffer_t* buffer)
+	{
+		return buffer->base;
+	}
+
+	size_t get_vm_buffer_size(const vm_buffer_t* buffer)
+	{
+		return buffer->size;
+	}
+
+	size_t get_vm_buffer_capacity(const vm_buffer_t* buffer)
+	{
+		return buffer->capacity;
+	}
+
+	void resize_vm_buffer(vm_buffer_t* buffer, size_t size)
+	{
+		if (size > buffer->committed)
+		{
+			buffer->committed = commit_pages(buffer->base, buffer->committed, buffer->capacity, size, buffer->tag);
+		}
+		else
+		{
+			buffer->committed = decommit_pages(buffer->base, buffer->committed, size, buffer->tag);
+		}
+
+		buffer->size = size;
+	}
+
+	void* grow_vm_buffer(vm_buffer_t* buffer, size_t size)
+	{
+		AUX_DEBUG_ASSERT(size > 0);
+
+		size_t offset = buffer->size;
+		size_t end = offset + size;
+
+		if (end > buffer->committed)
+		{
+			buffer->committed = commit_pages(buffer->base, buffer->committed, buffer->capacity, end, buffer->tag);
+		}
+
+		buffer->size = end;
+		return buffer->base + offset;
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Pool functions
+	//
+	///////////////////////////////////////////////////////////
+
+	slab_pool_t* create_slab_pool(size_t item_size)
+	{
+		AUX_DEBUG_ASSERT(item_size > 0);
+		AUX_DEBUG_ASSERT(item_size <= slab_size - slab_header_size);
+
+		slab_pool_t* pool = (slab_pool_t*)alloc_mem_aligned(sizeof(slab_pool_t), cache_line_size, MEM_TAG_POOL);
+		InitializeSListHead(&pool->free_items);
+		InitializeSRWLock(&pool->lock);
+		pool->slabs = nullptr;
+		pool->slab_pos = 0;
+		pool->item_size = align_size(item_size, MEMORY_ALLOCATION_ALIGNMENT);
+		return pool;
+	}
+
+	void destroy_slab_pool(slab_pool_t* pool)
+	{
+		u8_t* slab = pool->slabs;
+
+		while (slab != nullptr)
+		{
+			u8_t* next = *(u8_t**)slab;
+			VirtualFree(slab, 0, MEM_RELEASE);
+			add_live_bytes(MEM_TAG_POOL, -(i64_t)slab_size);
+			slab = next;
+		}
+
+		free_mem_aligned(pool);
+	}
+
+	void* alloc_slab_item(slab_pool_t* pool)
+	{
+		return pop_slab_item(pool, pool->item_size);
+	}
+
+	void free_slab_item(slab_pool_t* pool, void* item)
+	{
+		AUX_DEBUG_ASSERT(item != nullptr);
+
+		push_slab_item(pool, item);
+	}
+
+	void* alloc_small_mem(size_t size)
+	{
+		AUX_DEBUG_ASSERT(size > 0);
+
+		if (size > small_mem_max_size)
+		{
+			return alloc_mem(size);
+		}
+
+		size_t index = (size - 1) / small_mem_granularity;
+		return pop_slab_item(&small_pools[index], (index + 1) * small_mem_granularity);
+	}
+
+	void free_small_mem(void* mem, size_t size)
+	{
+		AUX_DEBUG_ASSERT(mem != nullptr);
+
+		if (size > small_mem_max_size)
+		{
+			free_mem(mem);
+			return;
+		}
+
+		push_slab_item(&small_pools[(size - 1) / small_mem_granularity], mem);
 	}
 }
@@ -0,0 +1,374 @@
+#include "bitset.h"
+
+#pragma warning(push, 0)
+
+#include <intrin.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	enum
+	{
+		BIT_OP_BAD_ENUM = -1,
+
+		BIT_OP_AND,
+		BIT_OP_OR,
+		BIT_OP_XOR,
+		BIT_OP_AND_NOT,
+
+		BIT_OP_MAX_ENUMS
+	};
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static size_t count_word(u64_t word)
+	{
+		word = word - ((word >> 1) & 0x5555555555555555ull);
+		word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+		word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+		return (size_t)((word * 0x0101010101010101ull) >> 56);
+	}
+
+	static u64_t combine_word(e32_t op, u64_t dst, u64_t src)
+	{
+		switch (op)
+		{
+			case BIT_OP_AND:
+				return dst & src;
+			case BIT_OP_OR:
+				return dst | src;
+			case BIT_OP_XOR:
+				return dst ^ src;
+			default:
+				return dst & ~src;
+		}
+	}
+
+	static u64_t get_low_word(__m128i value)
+	{
+		#if defined(_M_X64)
+		return (u64_t)_mm_cvtsi128_si64(value);
+		#else
+		return (u64_t)(u32_t)_mm_cvtsi128_si32(value) | ((u64_t)(u32_t)_mm_cvtsi128_si32(_mm_srli_epi64(value, 32)) << 32);
+		#endif
+	}
+
+	struct bits_sse2_t
+	{
+		typedef __m128i vec_t;
+		static const size_t width = 2;
+
+		static vec_t load(const u64_t* words)
+		{
+			return _mm_loadu_si128((const __m128i*)words);
+		}
+
+		static void store(u64_t* words, vec_t value)
+		{
+			_mm_storeu_si128((__m128i*)words, value);
+		}
+
+		static vec_t combine(e32_t op, vec_t dst, vec_t src)
+		{
+			switch (op)
+			{
+				case BIT_OP_AND:
+					return _mm_and_si128(dst, src);
+				case BIT_OP_OR:
+					return _mm_or_si128(dst, src);
+				case BIT_OP_XOR:
+					return _mm_xor_si128(dst, src);
+				default:
+					return _mm_andnot_si128(src, dst);
+			}
+		}
+
+		static bool is_zero(vec_t value)
+		{
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_setzero_si128())) == 0xffff;
+		}
+
+		// SSE2 has no byte shuffle, so counting stays in general registers
+		static size_t count(vec_t value)
+		{
+			return count_word(get_low_word(value)) + count_word(get_low_word(_mm_unpackhi_epi64(value, value)));
+		}
+
+		static void finish()
+		{
+		}
+	};
+
+	struct bits_avx2_t
+	{
+		typedef __m256i vec_t;
+		static const size_t width = 4;
+
+		static vec_t load(const u64_t* words)
+		{
+			return _mm256_loadu_si256((const __m256i*)words);
+		}
+
+		static void store(u64_t* words, vec_t value)
+		{
+			_mm256_storeu_si256((__m256i*)words, value);
+		}
+
+		static vec_t combine(e32_t op, vec_t dst, vec_t src)
+		{
+			switch (op)
+			{
+				case BIT_OP_AND:
+					return _mm256_and_si256(dst, src);
+				case BIT_OP_OR:
+					return _mm256_or_si256(dst, src);
+				case BIT_OP_XOR:
+					return _mm256_xor_si256(dst, src);
+				default:
+					return _mm256_andnot_si256(src, dst);
+			}
+		}
+
+		static bool is_zero(vec_t value)
+		{
+			return _mm256_testz_si256(value, value) != 0;
+		}
+
+		// Nibble lookup with a byte shuffle, then horizontal byte sums per 64-bit lane
+		static size_t count(vec_t value)
+		{
+			const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+			const __m256i low_mask = _mm256_set1_epi8(0x0f);
+			__m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(value, low_mask));
+			__m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(value, 4), low_mask));
+			__m256i sums = _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+			__m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+			return (size_t)(get_low_word(half) + get_low_word(_mm_unpackhi_epi64(half, half)));
+		}
+
+		static void finish()
+		{
+			_mm256_zeroupper();
+		}
+	};
+
+	template<typename T, e32_t op>
+	static void combine_words(u64_t* dst, const u64_t* src, size_t word_count)
+	{
+		size_t i = 0;
+
+		for (; i + T::width <= word_count; i += T::width)
+		{
+			T::store(dst + i, T::combine(op, T::load(dst + i), T::load(src + i)));
+		}
+
+		for (; i < word_count; ++i)
+		{
+			dst[i] = combine_word(op, dst[i], src[i]);
+		}
+
+		T::finish();
+	}
+
+	// The operation is a template argument so that the vector loops carry no branches
+	template<typename T>
+	static void combine_simd(e32_t op, u64_t* dst, const u64_t* src, size_t word_count)
+	{
+		switch (op)
+		{
+			case BIT_OP_AND:
+				combine_words<T, BIT_OP_AND>(dst, src, word_count);
+				break;
+			case BIT_OP_OR:
+				combine_words<T, BIT_OP_OR>(dst, src, word_count);
+				break;
+			case BIT_OP_XOR:
+				combine_words<T, BIT_OP_XOR>(dst, src, word_count);
+				break;
+			default:
+				combine_words<T, BIT_OP_AND_NOT>(dst, src, word_count);
+				break;
+		}
+	}
+
+	template<typename T>
+	static size_t count_simd(const u64_t* words, size_t word_count)
+	{
+		size_t count = 0;
+		size_t i = 0;
+
+		for (; i + T::width <= word_count; i += T::width)
+		{
+			count += T::count(T::load(words + i));
+		}
+
+		for (; i < word_count; ++i)
+		{
+			count += count_word(words[i]);
+		}
+
+		T::finish();
+		return count;
+	}
+
+	template<typename T>
+	static size_t diff_simd(const u64_t* lhs, const u64_t* rhs, u64_t* diff, size_t word_count)
+	{
+		size_t count = 0;
+		size_t i = 0;
+
+		for (; i + T::width <= word_count; i += T::width)
+		{
+			typename T::vec_t bits = T::combine(BIT_OP_XOR, T::load(lhs + i), T::load(rhs + i));
+			T::store(diff + i, bits);
+			count += T::count(bits);
+		}
+
+		for (; i < word_count; ++i)
+		{
+			diff[i] = lhs[i] ^ rhs[i];
+			count += count_word(diff[i]);
+		}
+
+		T::finish();
+		return count;
+	}
+
+	template<typename T>
+	static size_t find_simd(const u64_t* words, size_t word_count, size_t pos)
+	{
+		size_t i = pos / 64;
+
+		if (i >= word_count)
+		{
+			return invalid_bit_index;
+		}
+
+		// The first word is masked below pos, whole vectors of empty words are skipped after it
+		u64_t word = words[i] & (~(u64_t)0 << (pos % 64));
+
+		if (word != 0)
+		{
+			return i * 64 + find_lowest_bit(word);
+		}
+
+		++i;
+
+		while ((i + T::width <= word_count) && T::is_zero(T::load(words + i)))
+		{
+			i += T::width;
+		}
+
+		T::finish();
+
+		for (; i < word_count; ++i)
+		{
+			if (words[i] != 0)
+			{
+				return i * 64 + find_lowest_bit(words[i]);
+			}
+		}
+
+		return invalid_bit_index;
+	}
+
+	static void detect_bits_simd();
+
+	static void combine_detect(e32_t op, u64_t* dst, const u64_t* src, size_t word_count);
+	static size_t count_detect(const u64_t* words, size_t word_count);
+	static size_t diff_detect(const u64_t* lhs, const u64_t* rhs, u64_t* diff, size_t word_count);
+	static size_t find_detect(const u64_t* words, size_t word_count, size_t pos);
+
+	static void(*combine_func)(e32_t op, u64_t* dst, const u64_t* src, size_t word_count) = &combine_detect;
+	static size_t(*count_func)(const u64_t* words, size_t word_count) = &count_detect;
+	static size_t(*diff_func)(const u64_t* lhs, const u64_t* rhs, u64_t* diff, size_t word_count) = &diff_detect;
+	static size_t(*find_func)(const u64_t* words, size_t word_count, size_t pos) = &find_detect;
+
+	static void combine_detect(e32_t op, u64_t* dst, const u64_t* src, size_t word_count)
+	{
+		detect_bits_simd();
+		combine_func(op, dst, src, word_count);
+	}
+
+	static size_t count_detect(const u64_t* words, size_t word_count)
+	{
+		detect_bits_simd();
+		return count_func(words, word_count);
+	}
+
+	static size_t diff_detect(const u64_t* lhs, const u64_t* rhs, u64_t* diff, size_t word_count)
+	{
+		detect_bits_simd();
+		return diff_func(lhs, rhs, diff, word_count);
+	}
+
+	static size_t find_detect(const u64_t* words, size_t word_count, size_t pos)
+	{
+		detect_bits_simd();
+		return find_func(words, word_count, pos);
+	}
+
+	static void detect_bits_simd()
+	{
+		if (has_cpu_feature(CPU_FEATURE_AVX2))
+		{
+			find_func = &find_simd<bits_avx2_t>;
+			diff_func = &diff_simd<bits_avx2_t>;
+			count_func = &count_simd<bits_avx2_t>;
+			combine_func = &combine_simd<bits_avx2_t>;
+		}
+		else
+		{
+			find_func = &find_simd<bits_sse2_t>;
+			diff_func = &diff_simd<bits_sse2_t>;
+			count_func = &count_simd<bits_sse2_t>;
+			combine_func = &combine_simd<bits_sse2_t>;
+		}
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Bit functions
+	//
+	///////////////////////////////////////////////////////////
+
+	void and_bits(u64_t* dst, const u64_t* src, size_t word_count)
+	{
+		combine_func(BIT_OP_AND, dst, src, word_count);
+	}
+
+	void or_bits(u64_t* dst, const u64_t* src, size_t word_count)
+	{
+		combine_func(BIT_OP_OR, dst, src, word_count);
+	}
+
+	void xor_bits(u64_t* dst, const u64_t* src, size_t word_count)
+	{
+		combine_func(BIT_OP_XOR, dst, src, word_count);
+	}
+
+	void and_not_bits(u64_t* dst, const u64_t* src, size_t word_count)
+	{
+		combine_func(BIT_OP_AND_NOT, dst, src, word_count);
+	}
+
+	size_t count_bits(const u64_t* words, size_t word_count)
+	{
+		return count_func(words, word_count);
+	}
+
+	size_t diff_bits(const u64_t* lhs, const u64_t* rhs, u64_t* diff, size_t word_count)
+	{
+		return diff_func(lhs, rhs, diff, word_count);
+	}
+
+	size_t find_next_bit(const u64_t* words, size_t word_count, size_t pos)
+	{
+		return find_func(words, word_count, pos);
+	}
+}
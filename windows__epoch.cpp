@@ -0,0 +1,276 @@
+#include "epoch.h"
+
+#pragma warning(push, 0)
+
+#define WIN32_LEAN_AND_MEAN
+#define STRICT
+#include <windows.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	static const u32_t epoch_batch_size = 64;
+	static const i32_t epoch_bag_count = 3;
+	static const LONG64 epoch_active = 1;
+
+	#pragma pack(1)
+
+	struct retired_mem_t
+	{
+		void* mem;
+		retire_handler_t handler;
+	};
+
+	#pragma pack()
+
+	struct epoch_bag_t
+	{
+		i64_t epoch;
+		retired_mem_t* items;
+		u32_t count;
+		u32_t capacity;
+	};
+
+	// Records are never freed, threads that exit leave theirs to be reused along with any bags still pending
+	struct alignas(cache_line_size) epoch_thread_t
+	{
+		volatile LONG64 state;
+		volatile LONG in_use;
+		epoch_thread_t* next;
+		u32_t nesting;
+		u32_t retired_count;
+		epoch_bag_t bags[epoch_bag_count];
+	};
+
+	static volatile LONG64 global_epoch = epoch_bag_count;
+	static epoch_thread_t* volatile threads_list = nullptr;
+	static SRWLOCK epoch_lock = SRWLOCK_INIT;
+	static DWORD epoch_index = FLS_OUT_OF_INDEXES;
+	static __declspec(thread) epoch_thread_t* epoch_thread = nullptr;
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static void push_bag(epoch_bag_t& bag, void* mem, retire_handler_t handler)
+	{
+		if (bag.count == bag.capacity)
+		{
+			u32_t capacity = (bag.capacity == 0) ? epoch_batch_size : bag.capacity * 2;
+			retired_mem_t* items = (retired_mem_t*)alloc_mem(sizeof(retired_mem_t) * capacity);
+
+			if (bag.items != nullptr)
+			{
+				copy_mem(bag.items, items, sizeof(retired_mem_t) * bag.count);
+				free_mem(bag.items);
+			}
+
+			bag.items = items;
+			bag.capacity = capacity;
+		}
+
+		retired_mem_t& item = bag.items[bag.count++];
+		item.mem = mem;
+		item.handler = handler;
+	}
+
+	static void free_bag(epoch_bag_t& bag)
+	{
+		for (u32_t i = 0; i < bag.count; ++i)
+		{
+			retired_mem_t& item = bag.items[i];
+
+			if (item.handler != nullptr)
+			{
+				item.handler(item.mem);
+			}
+			else
+			{
+				free_mem(item.mem);
+			}
+		}
+
+		bag.count = 0;
+	}
+
+	// Memory retired in an epoch is unreachable once the global epoch has moved two steps past it
+	static bool is_bag_safe(const epoch_bag_t& bag, i64_t epoch)
+	{
+		return bag.epoch + 2 <= epoch;
+	}
+
+	static i64_t try_advance_epoch()
+	{
+		LONG64 epoch = global_epoch;
+
+		for (epoch_thread_t* thread = threads_list; thread != nullptr; thread = thread->next)
+		{
+			LONG64 state = thread->state;
+
+			if ((state & epoch_active) && ((state >> 1) != epoch))
+			{
+				return epoch;
+			}
+		}
+
+		InterlockedCompareExchange64(&global_epoch, epoch + 1, epoch);
+		return global_epoch;
+	}
+
+	static void collect_thread(epoch_thread_t* thread, i64_t epoch)
+	{
+		for (i32_t i = 0; i < epoch_bag_count; ++i)
+		{
+			epoch_bag_t& bag = thread->bags[i];
+
+			if ((bag.count > 0) && is_bag_safe(bag, epoch))
+			{
+				free_bag(bag);
+			}
+		}
+	}
+
+	// Bags left in the records of exited threads are collected by whichever thread claims the record first
+	static void collect_idle_threads(i64_t epoch)
+	{
+		for (epoch_thread_t* thread = threads_list; thread != nullptr; thread = thread->next)
+		{
+			if ((thread->in_use == 0) && (InterlockedCompareExchange(&thread->in_use, 1, 0) == 0))
+			{
+				collect_thread(thread, epoch);
+				InterlockedExchange(&thread->in_use, 0);
+			}
+		}
+	}
+
+	// Other FLS callbacks may already have torn down the heap state of this thread, so nothing is allocated or freed here
+	static void WINAPI on_thread_exit(void* param)
+	{
+		epoch_thread_t* thread = (epoch_thread_t*)param;
+
+		if (thread == nullptr)
+		{
+			return;
+		}
+
+		InterlockedExchange64(&thread->state, 0);
+		thread->nesting = 0;
+		thread->retired_count = 0;
+		InterlockedExchange(&thread->in_use, 0);
+		epoch_thread = nullptr;
+	}
+
+	static epoch_thread_t* get_epoch_thread()
+	{
+		epoch_thread_t* thread = epoch_thread;
+
+		if (thread != nullptr)
+		{
+			return thread;
+		}
+
+		for (thread = threads_list; thread != nullptr; thread = thread->next)
+		{
+			if ((thread->in_use == 0) && (InterlockedCompareExchange(&thread->in_use, 1, 0) == 0))
+			{
+				break;
+			}
+		}
+
+		AcquireSRWLockExclusive(&epoch_lock);
+
+		if (epoch_index == FLS_OUT_OF_INDEXES)
+		{
+			epoch_index = FlsAlloc(&on_thread_exit);
+		}
+
+		if (thread == nullptr)
+		{
+			thread = (epoch_thread_t*)zalloc_mem_aligned(sizeof(epoch_thread_t), cache_line_size);
+			thread->in_use = 1;
+			thread->next = threads_list;
+			InterlockedExchangePointer((PVOID volatile*)&threads_list, thread);
+		}
+
+		ReleaseSRWLockExclusive(&epoch_lock);
+
+		if (epoch_index != FLS_OUT_OF_INDEXES)
+		{
+			FlsSetValue(epoch_index, thread);
+		}
+
+		epoch_thread = thread;
+		return thread;
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Epoch functions
+	//
+	///////////////////////////////////////////////////////////
+
+	void enter_epoch()
+	{
+		epoch_thread_t* thread = get_epoch_thread();
+
+		if (thread->nesting++ == 0)
+		{
+			// The full barrier keeps shared reads from moving above the announcement
+			InterlockedExchange64(&thread->state, (global_epoch << 1) | epoch_active);
+		}
+	}
+
+	void exit_epoch()
+	{
+		epoch_thread_t* thread = epoch_thread;
+		AUX_DEBUG_ASSERT((thread != nullptr) && (thread->nesting > 0));
+
+		if (--thread->nesting == 0)
+		{
+			InterlockedExchange64(&thread->state, 0);
+		}
+	}
+
+	void retire_mem(void* mem, retire_handler_t handler)
+	{
+		AUX_DEBUG_ASSERT(mem != nullptr);
+
+		epoch_thread_t* thread = get_epoch_thread();
+		i64_t epoch = global_epoch;
+		epoch_bag_t& bag = thread->bags[epoch % epoch_bag_count];
+
+		// A bag still holding an older epoch is at least three epochs old
+		if (bag.epoch != epoch)
+		{
+			free_bag(bag);
+			bag.epoch = epoch;
+		}
+
+		push_bag(bag, mem, handler);
+
+		if (++thread->retired_count >= epoch_batch_size)
+		{
+			thread->retired_count = 0;
+			epoch = try_advance_epoch();
+			collect_thread(thread, epoch);
+			collect_idle_threads(epoch);
+		}
+	}
+
+	void flush_retired_mem()
+	{
+		epoch_thread_t* thread = get_epoch_thread();
+
+		for (i32_t i = 0; i < 2; ++i)
+		{
+			i64_t epoch = try_advance_epoch();
+			collect_thread(thread, epoch);
+			collect_idle_threads(epoch);
+		}
+
+		thread->retired_count = 0;
+	}
+}
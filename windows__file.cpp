@@ -38,7 +38,7 @@ namespace aux
 
 			if (handle != INVALID_HANDLE_VALUE)
 			{
-				file_t* file = (file_t*)alloc_mem(sizeof(file_t));
+				file_t* file = (file_t*)alloc_small_mem(sizeof(file_t));
 				file->handle = handle;
 				file->mode = mode;
 				return file;
@@ -106,7 +106,7 @@ namespace aux
 	void close_file(file_t* file)
 	{
 		CloseHandle(file->handle);
-		free_mem(file);
+		free_small_mem(file, sizeof(file_t));
 	}
 
 	u32_t read_file(file_t* file, u32_t size, void* data)
@@ -504,7 +504,7 @@ namespace aux
 
 	bool internal__init_graphics(HWND window)
 	{
-		graphics = (renderer_t*)zalloc_mem(sizeof(renderer_t));
+		graphics = (renderer_t*)zalloc_mem_tagged(sizeof(renderer_t), MEM_TAG_GRAPHICS);
 		graphics->window = window;
 		RECT client;
 
@@ -725,7 +725,7 @@ namespace aux
 
 		if (view != nullptr)
 		{
-			texture_t* texture = (texture_t*)alloc_mem(sizeof(texture_t));
+			texture_t* texture = (texture_t*)alloc_small_mem(sizeof(texture_t));
 			texture->view = view;
 			texture->width = width;
 			texture->height = height;
@@ -738,7 +738,7 @@ namespace aux
 	void destroy_texture(texture_t* texture)
 	{
 		texture->view->Release();
-		free_mem(texture);
+		free_small_mem(texture, sizeof(texture_t));
 	}
 
 	void update_texture(texture_t* texture, i32_t level, const point2_t& offset, const size2_t& size, const void* data)
@@ -830,7 +830,7 @@ namespace aux
 
 		if (SUCCEEDED(result))
 		{
-			sampler_t* sampler = (sampler_t*)alloc_mem(sizeof(sampler_t));
+			sampler_t* sampler = (sampler_t*)alloc_small_mem(sizeof(sampler_t));
 			sampler->state = state;
 			return sampler;
 		}
@@ -841,6 +841,8 @@ namespace aux
 
 	void destroy_sampler(sampler_t* sampler)
 	{
+		sampler->state->Release();
+		free_small_mem(sampler, sizeof(sampler_t));
 	}
 
 	vertex_buffer_t* create_vertex_buffer(bool dynamic, i32_t vertex_size, i32_t vertex_count, const void* data)
@@ -853,7 +855,7 @@ namespace aux
 
 		if (create_buffer(&resource, D3D10_BIND_VERTEX_BUFFER, dynamic, size, data))
 		{
-			vertex_buffer_t* buffer = (vertex_buffer_t*)alloc_mem(sizeof(vertex_buffer_t));
+			vertex_buffer_t* buffer = (vertex_buffer_t*)alloc_small_mem(sizeof(vertex_buffer_t));
 			buffer->buffer = resource;
 			buffer->vertex_size = vertex_size;
 			buffer->vertex_count = vertex_count;
@@ -872,7 +874,7 @@ namespace aux
 		}
 
 		buffer->buffer->Release();
-		free_mem(buffer);
+		free_small_mem(buffer, sizeof(vertex_buffer_t));
 	}
 
 	void update_vertex_buffer(vertex_buffer_t* buffer, i32_t start_vertex, i32_t vertex_count, const void* data)
@@ -904,7 +906,7 @@ namespace aux
 
 		if (create_buffer(&resource, D3D10_BIND_INDEX_BUFFER, dynamic, size, data))
 		{
-			index_buffer_t* buffer = (index_buffer_t*)alloc_mem(sizeof(index_buffer_t));
+			index_buffer_t* buffer = (index_buffer_t*)alloc_small_mem(sizeof(index_buffer_t));
 			buffer->buffer = resource;
 			buffer->dxgi_format = get_index_format(index_format);
 			buffer->index_format = index_format;
@@ -925,7 +927,7 @@ namespace aux
 		}
 
 		buffer->buffer->Release();
-		free_mem(buffer);
+		free_small_mem(buffer, sizeof(index_buffer_t));
 	}
 
 	void update_index_buffer(index_buffer_t* buffer, i32_t start_index, i32_t index_count, const void* data)
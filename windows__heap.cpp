@@ -0,0 +1,385 @@
+#include "base.h"
+
+#pragma warning(push, 0)
+
+#include <string.h>
+#include <intrin.h>
+
+#define WIN32_LEAN_AND_MEAN
+#define STRICT
+#include <windows.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	static const u32_t chunk_bits = 16;
+	static const size_t chunk_size = (size_t)1 << chunk_bits;
+	static const u32_t page_map_bits = 16;
+	static const size_t page_map_size = (size_t)1 << page_map_bits;
+	static const size_t tiny_class_size = 16;
+	static const size_t tiny_class_max_size = 128;
+	static const u32_t tiny_class_count = 8;
+	static const u32_t class_count = 52;
+	static const size_t max_class_size = 256 * 1024;
+	static const u32_t max_magazine_size = 64;
+	static const u8_t large_chunk = 0xff;
+
+	struct magazine_t
+	{
+		u32_t count;
+		u32_t limit;
+		void* items[max_magazine_size];
+	};
+
+	struct thread_cache_t
+	{
+		magazine_t magazines[class_count];
+	};
+
+	struct alignas(cache_line_size) size_class_t
+	{
+		SLIST_HEADER depot;
+		SRWLOCK lock;
+		u8_t* span_pos;
+		u8_t* span_end;
+	};
+
+	static size_class_t size_classes[class_count] = {};
+	static u8_t* volatile page_map[page_map_size] = {};
+	static DWORD cache_index = FLS_OUT_OF_INDEXES;
+	static __declspec(thread) thread_cache_t* thread_cache = nullptr;
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static u32_t log2_floor(size_t value)
+	{
+		unsigned long index;
+
+		#if defined(_M_X64)
+		_BitScanReverse64(&index, (u64_t)value);
+		#else
+		_BitScanReverse(&index, (unsigned long)value);
+		#endif
+
+		return (u32_t)index;
+	}
+
+	static u32_t get_class_index(size_t size)
+	{
+		if (size <= tiny_class_max_size)
+		{
+			return (u32_t)((size + tiny_class_size - 1) / tiny_class_size) - 1;
+		}
+
+		// Four classes per doubling above the tiny range
+		u32_t shift = log2_floor(size - 1);
+		return tiny_class_count + (shift - 7) * 4 + (u32_t)(((size - 1) >> (shift - 2)) & 3);
+	}
+
+	static size_t get_class_size(u32_t index)
+	{
+		if (index < tiny_class_count)
+		{
+			return (index + 1) * tiny_class_size;
+		}
+
+		u32_t step = index - tiny_class_count;
+		size_t base = tiny_class_max_size << (step / 4);
+		return base + (step % 4 + 1) * (base / 4);
+	}
+
+	static size_t get_span_size(u32_t index)
+	{
+		size_t size = get_class_size(index) * 8;
+		return (size < chunk_size) ? chunk_size : (size + chunk_size - 1) & ~(chunk_size - 1);
+	}
+
+	static u32_t get_magazine_limit(u32_t index)
+	{
+		size_t limit = chunk_size / get_class_size(index);
+		return (u32_t)clamp<size_t>(limit, 4, max_magazine_size);
+	}
+
+	static u8_t* get_page_map_leaf(size_t chunk, bool create)
+	{
+		size_t slot = (chunk >> page_map_bits) & (page_map_size - 1);
+		u8_t* leaf = page_map[slot];
+
+		if ((leaf == nullptr) && create)
+		{
+			u8_t* new_leaf = (u8_t*)VirtualAlloc(nullptr, page_map_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+			if (new_leaf == nullptr)
+			{
+				return nullptr;
+			}
+
+			leaf = (u8_t*)InterlockedCompareExchangePointer((PVOID volatile*)&page_map[slot], new_leaf, nullptr);
+
+			if (leaf == nullptr)
+			{
+				leaf = new_leaf;
+			}
+			else
+			{
+				VirtualFree(new_leaf, 0, MEM_RELEASE);
+			}
+		}
+
+		return leaf;
+	}
+
+	static bool mark_chunks(void* mem, size_t size, u8_t value)
+	{
+		size_t first = (size_t)mem >> chunk_bits;
+		size_t last = ((size_t)mem + size - 1) >> chunk_bits;
+
+		for (size_t chunk = first; chunk <= last; ++chunk)
+		{
+			u8_t* leaf = get_page_map_leaf(chunk, true);
+
+			if (leaf == nullptr)
+			{
+				return false;
+			}
+
+			leaf[chunk & (page_map_size - 1)] = value;
+		}
+
+		return true;
+	}
+
+	static u8_t find_chunk(const void* mem)
+	{
+		size_t chunk = (size_t)mem >> chunk_bits;
+		const u8_t* leaf = get_page_map_leaf(chunk, false);
+		AUX_DEBUG_ASSERT(leaf != nullptr);
+		return leaf[chunk & (page_map_size - 1)];
+	}
+
+	static void* alloc_large(size_t size)
+	{
+		void* mem = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+		if ((mem != nullptr) && !mark_chunks(mem, 1, large_chunk))
+		{
+			VirtualFree(mem, 0, MEM_RELEASE);
+			return nullptr;
+		}
+
+		return mem;
+	}
+
+	static void free_large(void* mem)
+	{
+		mark_chunks(mem, 1, 0);
+		VirtualFree(mem, 0, MEM_RELEASE);
+	}
+
+	static void flush_magazine(u32_t index, magazine_t& magazine, u32_t count)
+	{
+		size_class_t& size_class = size_classes[index];
+
+		while (count > 0)
+		{
+			InterlockedPushEntrySList(&size_class.depot, (PSLIST_ENTRY)magazine.items[--magazine.count]);
+			--count;
+		}
+	}
+
+	static void refill_magazine(u32_t index, magazine_t& magazine)
+	{
+		size_class_t& size_class = size_classes[index];
+		u32_t count = magazine.limit / 2;
+
+		while (magazine.count < count)
+		{
+			void* item = InterlockedPopEntrySList(&size_class.depot);
+
+			if (item == nullptr)
+			{
+				break;
+			}
+
+			magazine.items[magazine.count++] = item;
+		}
+	}
+
+	static void* carve_blocks(u32_t index, magazine_t& magazine)
+	{
+		size_class_t& size_class = size_classes[index];
+		size_t block_size = get_class_size(index);
+		AcquireSRWLockExclusive(&size_class.lock);
+
+		if ((size_t)(size_class.span_end - size_class.span_pos) < block_size)
+		{
+			size_t span_size = get_span_size(index);
+			u8_t* span = (u8_t*)VirtualAlloc(nullptr, span_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+			if ((span == nullptr) || !mark_chunks(span, span_size, (u8_t)(index + 1)))
+			{
+				ReleaseSRWLockExclusive(&size_class.lock);
+
+				if (span != nullptr)
+				{
+					VirtualFree(span, 0, MEM_RELEASE);
+				}
+
+				return nullptr;
+			}
+
+			size_class.span_pos = span;
+			size_class.span_end = span + span_size;
+		}
+
+		// Blocks carved from a fresh span are still zero pages
+		u8_t* block = size_class.span_pos;
+		size_class.span_pos += block_size;
+
+		while ((magazine.count < magazine.limit / 2) && ((size_t)(size_class.span_end - size_class.span_pos) >= block_size))
+		{
+			magazine.items[magazine.count++] = size_class.span_pos;
+			size_class.span_pos += block_size;
+		}
+
+		ReleaseSRWLockExclusive(&size_class.lock);
+		return block;
+	}
+
+	static void WINAPI on_thread_exit(void* param)
+	{
+		thread_cache_t* cache = (thread_cache_t*)param;
+
+		if (cache != nullptr)
+		{
+			for (u32_t i = 0; i < class_count; ++i)
+			{
+				flush_magazine(i, cache->magazines[i], cache->magazines[i].count);
+			}
+
+			VirtualFree(cache, 0, MEM_RELEASE);
+			thread_cache = nullptr;
+		}
+	}
+
+	static thread_cache_t* get_thread_cache()
+	{
+		thread_cache_t* cache = thread_cache;
+
+		if (cache != nullptr)
+		{
+			return cache;
+		}
+
+		cache = (thread_cache_t*)VirtualAlloc(nullptr, sizeof(thread_cache_t), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+
+		if (cache == nullptr)
+		{
+			return nullptr;
+		}
+
+		for (u32_t i = 0; i < class_count; ++i)
+		{
+			cache->magazines[i].limit = get_magazine_limit(i);
+		}
+
+		FlsSetValue(cache_index, cache);
+		thread_cache = cache;
+		return cache;
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Internal functions
+	//
+	///////////////////////////////////////////////////////////
+
+	bool internal__init_heap()
+	{
+		if (cache_index == FLS_OUT_OF_INDEXES)
+		{
+			for (u32_t i = 0; i < class_count; ++i)
+			{
+				InitializeSListHead(&size_classes[i].depot);
+				InitializeSRWLock(&size_classes[i].lock);
+			}
+
+			cache_index = FlsAlloc(&on_thread_exit);
+		}
+
+		return cache_index != FLS_OUT_OF_INDEXES;
+	}
+
+	void* internal__alloc_heap(size_t size, bool zeroed)
+	{
+		if (size > max_class_size)
+		{
+			return alloc_large(size);
+		}
+
+		thread_cache_t* cache = get_thread_cache();
+
+		if (cache == nullptr)
+		{
+			return nullptr;
+		}
+
+		u32_t index = get_class_index(size);
+		magazine_t& magazine = cache->magazines[index];
+
+		if (magazine.count == 0)
+		{
+			refill_magazine(index, magazine);
+
+			if (magazine.count == 0)
+			{
+				return carve_blocks(index, magazine);
+			}
+		}
+
+		void* mem = magazine.items[--magazine.count];
+
+		if (zeroed)
+		{
+			memset(mem, 0, size);
+		}
+
+		return mem;
+	}
+
+	void internal__free_heap(void* mem)
+	{
+		u8_t chunk = find_chunk(mem);
+
+		if (chunk == large_chunk)
+		{
+			free_large(mem);
+			return;
+		}
+
+		AUX_DEBUG_ASSERT(chunk != 0);
+
+		u32_t index = (u32_t)chunk - 1;
+		thread_cache_t* cache = get_thread_cache();
+
+		if (cache == nullptr)
+		{
+			InterlockedPushEntrySList(&size_classes[index].depot, (PSLIST_ENTRY)mem);
+			return;
+		}
+
+		magazine_t& magazine = cache->magazines[index];
+
+		if (magazine.count == magazine.limit)
+		{
+			flush_magazine(index, magazine, magazine.limit / 2);
+		}
+
+		magazine.items[magazine.count++] = mem;
+	}
+}
@@ -1,4 +1,5 @@
 #include "input.h"
+#include "bitset.h"
 
 #pragma warning(push, 0)
 
@@ -53,7 +54,7 @@ namespace aux
 	struct input_t
 	{
 		HWND window;
-		u8_t keys[KEY_MAX_ENUMS];
+		bitset_t<KEY_MAX_ENUMS> keys;
 		u8_t indicators[INDICATOR_MAX_ENUMS];
 		point2_t mouse_pos;
 		HCURSOR default_cursor;
@@ -361,9 +362,9 @@ namespace aux
 			return;
 		}
 
-		if (input->keys[k] == 0)
+		if (!input->keys.test_bit(k))
 		{
-			input->keys[k] = 1;
+			input->keys.set_bit(k);
 
 			switch (k)
 			{
@@ -394,9 +395,9 @@ namespace aux
 			return;
 		}
 
-		if (input->keys[k] != 0)
+		if (input->keys.test_bit(k))
 		{
-			input->keys[k] = 0;
+			input->keys.clear_bit(k);
 
 			if (input_handler.on_key_up != nullptr)
 			{
@@ -478,7 +479,7 @@ namespace aux
 	{
 		i32_t pitch = (size.w + 15) / 16;
 		size_t data_size = (size_t)pitch * (size_t)size.h;
-		void* temp = alloc_mem(data_size);
+		void* temp = alloc_mem_tagged(data_size, MEM_TAG_INPUT);
 		fill_mem(temp, 0xff, data_size);
 		HBITMAP bitmap = CreateBitmap(size.w, size.h, 1, 1, temp);
 		free_mem(temp);
@@ -513,10 +514,10 @@ namespace aux
 
 	bool internal__init_input(HWND window, HCURSOR default_cursor)
 	{
-		input = (input_t*)zalloc_mem(sizeof(input_t));
+		input = (input_t*)zalloc_mem_tagged(sizeof(input_t), MEM_TAG_INPUT);
 		input->window = window;
 		input->raw_buffer_size = sizeof(RAWINPUT);
-		input->raw_buffer = alloc_mem(sizeof(RAWINPUT));
+		input->raw_buffer = alloc_mem_tagged(sizeof(RAWINPUT), MEM_TAG_INPUT);
 		input->default_cursor = default_cursor;
 		input->current_cursor = default_cursor;
 
@@ -541,7 +542,7 @@ namespace aux
 
 	void internal__capture_input_focus()
 	{
-		zero_mem(input->keys, sizeof(input->keys));
+		input->keys.clear();
 		init_indicators();
 		init_mouse();
 	}
@@ -569,9 +570,9 @@ namespace aux
 			return;
 		}
 
-		if (input->keys[k] == 0)
+		if (!input->keys.test_bit(k))
 		{
-			input->keys[k] = 1;
+			input->keys.set_bit(k);
 
 			if (input_handler.on_double_click != nullptr)
 			{
@@ -625,7 +626,7 @@ namespace aux
 		{
 			free_mem(input->raw_buffer);
 			input->raw_buffer_size = size;
-			input->raw_buffer = alloc_mem((size_t)size);
+			input->raw_buffer = alloc_mem_tagged((size_t)size, MEM_TAG_INPUT);
 		}
 
 		if (GetRawInputData((HRAWINPUT)lparam, RID_INPUT, input->raw_buffer, &size, sizeof(RAWINPUTHEADER)) != (UINT)-1)
@@ -667,7 +668,7 @@ namespace aux
 	{
 		AUX_DEBUG_ASSERT((key >= 0) && (key < KEY_MAX_ENUMS));
 
-		return (bool)input->keys[key];
+		return input->keys.test_bit(key);
 	}
 
 	bool is_key_on(e32_t key)
@@ -725,7 +726,7 @@ namespace aux
 
 				if (handle != nullptr)
 				{
-					cursor_t* cursor = (cursor_t*)alloc_mem(sizeof(cursor_t));
+					cursor_t* cursor = (cursor_t*)alloc_small_mem(sizeof(cursor_t));
 					cursor->handle = handle;
 					DeleteObject(mask_map);
 					DeleteObject(color_map);
@@ -749,7 +750,7 @@ namespace aux
 		}
 
 		DestroyCursor(cursor->handle);
-		free_mem(cursor);
+		free_small_mem(cursor, sizeof(cursor_t));
 	}
 
 	void select_cursor(cursor_t* cursor)
@@ -0,0 +1,305 @@
+#include "intern.h"
+#include "hash_map.h"
+#include "epoch.h"
+#include "file.h"
+
+#pragma warning(push, 0)
+
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#define STRICT
+#include <windows.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	// Both ranges are only reserved up front, 32-bit builds keep them small to spare the address space
+	#if defined(_M_X64)
+	static const size_t intern_arena_capacity = (size_t)1 << 30;
+	static const u32_t max_interned_strings = 1 << 24;
+	#else
+	static const size_t intern_arena_capacity = (size_t)1 << 27;
+	static const u32_t max_interned_strings = 1 << 22;
+	#endif
+	static const u32_t min_table_size = 1024;
+	static const size_t length_size = sizeof(u32_t);
+
+	// Slots pack the hash above the id, zero marks an empty slot since ids start at 1
+	struct intern_table_t
+	{
+		u32_t mask;
+		volatile LONG64 slots[1];
+	};
+
+	static intern_table_t* volatile intern_table = nullptr;
+	static const char** intern_strings = nullptr;
+	static vm_buffer_t* intern_ids = nullptr;
+	static arena_t* intern_arena = nullptr;
+	static volatile LONG intern_count = 0;
+	static SRWLOCK intern_lock = SRWLOCK_INIT;
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static u32_t get_string_hash(const char str[], size_t length)
+	{
+		return (u32_t)hash_bytes(str, length);
+	}
+
+	static u32_t get_text_length(const char* text)
+	{
+		return *(const u32_t*)(text - length_size);
+	}
+
+	static u32_t find_in_table(const intern_table_t* table, const char str[], size_t length, u32_t hash)
+	{
+		for (u32_t pos = hash & table->mask;; pos = (pos + 1) & table->mask)
+		{
+			u64_t slot = (u64_t)table->slots[pos];
+
+			if (slot == 0)
+			{
+				return invalid_intern_id;
+			}
+
+			if ((u32_t)(slot >> 32) == hash)
+			{
+				u32_t id = (u32_t)slot;
+				const char* text = intern_strings[id - 1];
+
+				if ((get_text_length(text) == length) && (compare_mem(text, str, length) == 0))
+				{
+					return id;
+				}
+			}
+		}
+	}
+
+	static void insert_slot(intern_table_t* table, u32_t hash, u32_t id)
+	{
+		u32_t pos = hash & table->mask;
+
+		while (table->slots[pos] != 0)
+		{
+			pos = (pos + 1) & table->mask;
+		}
+
+		// Publishing the slot last makes the text and id visible to lock-free readers
+		InterlockedExchange64(&table->slots[pos], (LONG64)(((u64_t)hash << 32) | id));
+	}
+
+	static intern_table_t* alloc_table(u32_t size)
+	{
+		intern_table_t* table = (intern_table_t*)zalloc_mem(sizeof(intern_table_t) + sizeof(LONG64) * (size - 1));
+		table->mask = size - 1;
+		return table;
+	}
+
+	// Readers may still walk the old table, so it is retired instead of freed
+	static intern_table_t* grow_table(intern_table_t* table)
+	{
+		u32_t size = (table != nullptr) ? (table->mask + 1) * 2 : min_table_size;
+		intern_table_t* new_table = alloc_table(size);
+
+		if (table != nullptr)
+		{
+			for (u32_t i = 0; i <= table->mask; ++i)
+			{
+				u64_t slot = (u64_t)table->slots[i];
+
+				if (slot != 0)
+				{
+					insert_slot(new_table, (u32_t)(slot >> 32), (u32_t)slot);
+				}
+			}
+		}
+
+		InterlockedExchangePointer((PVOID volatile*)&intern_table, new_table);
+
+		if (table != nullptr)
+		{
+			retire_mem(table);
+		}
+
+		return new_table;
+	}
+
+	static void init_storage()
+	{
+		if (intern_arena == nullptr)
+		{
+			intern_arena = create_arena(intern_arena_capacity);
+			intern_ids = create_vm_buffer(sizeof(const char*) * max_interned_strings);
+			intern_strings = (const char**)get_vm_buffer_data(intern_ids);
+		}
+	}
+
+	static u32_t find_lock_free(const char str[], size_t length, u32_t hash)
+	{
+		epoch_scope_t scope;
+		const intern_table_t* table = intern_table;
+		return (table != nullptr) ? find_in_table(table, str, length, hash) : invalid_intern_id;
+	}
+
+	static const char* store_text(const char str[], size_t length)
+	{
+		u8_t* mem = (u8_t*)push_arena(intern_arena, length_size + length + 1);
+		*(u32_t*)mem = (u32_t)length;
+		char* text = (char*)mem + length_size;
+		copy_mem(str, text, length);
+		text[length] = '\0';
+		return text;
+	}
+
+	static void intern_lines(const char* data, size_t size)
+	{
+		const char* end = data + size;
+
+		while (data < end)
+		{
+			const char* line_end = (const char*)memchr(data, '\n', (size_t)(end - data));
+
+			if (line_end == nullptr)
+			{
+				line_end = end;
+			}
+
+			size_t length = (size_t)(line_end - data);
+
+			if ((length > 0) && (data[length - 1] == '\r'))
+			{
+				--length;
+			}
+
+			if (length > 0)
+			{
+				intern_string(data, length);
+			}
+
+			data = line_end + 1;
+		}
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Intern functions
+	//
+	///////////////////////////////////////////////////////////
+
+	u32_t intern_string(const char str[])
+	{
+		return intern_string(str, strlen(str));
+	}
+
+	u32_t intern_string(const char str[], size_t length)
+	{
+		AUX_DEBUG_ASSERT(length <= UINT32_MAX);
+
+		u32_t hash = get_string_hash(str, length);
+		u32_t id = find_lock_free(str, length, hash);
+
+		if (id != invalid_intern_id)
+		{
+			return id;
+		}
+
+		AcquireSRWLockExclusive(&intern_lock);
+		init_storage();
+
+		// Another thread may have added the string after the lock-free lookup
+		intern_table_t* table = intern_table;
+		id = (table != nullptr) ? find_in_table(table, str, length, hash) : invalid_intern_id;
+
+		if (id == invalid_intern_id)
+		{
+			AUX_DEBUG_ASSERT((u32_t)intern_count < max_interned_strings);
+
+			if ((table == nullptr) || ((u32_t)intern_count + 1 > (table->mask + 1) / 2))
+			{
+				table = grow_table(table);
+			}
+
+			*(const char**)grow_vm_buffer(intern_ids, sizeof(const char*)) = store_text(str, length);
+			id = (u32_t)InterlockedIncrement(&intern_count);
+			insert_slot(table, hash, id);
+		}
+
+		ReleaseSRWLockExclusive(&intern_lock);
+		return id;
+	}
+
+	u32_t find_interned_string(const char str[])
+	{
+		return find_interned_string(str, strlen(str));
+	}
+
+	u32_t find_interned_string(const char str[], size_t length)
+	{
+		return find_lock_free(str, length, get_string_hash(str, length));
+	}
+
+	const char* get_interned_string(u32_t id)
+	{
+		AUX_DEBUG_ASSERT((id != invalid_intern_id) && (id <= (u32_t)intern_count));
+
+		return intern_strings[id - 1];
+	}
+
+	size_t get_interned_length(u32_t id)
+	{
+		return get_text_length(get_interned_string(id));
+	}
+
+	u32_t get_interned_count()
+	{
+		return (u32_t)intern_count;
+	}
+
+	bool load_interned_strings(const char path[])
+	{
+		file_t* file = open_file(path, FILE_MODE_READ);
+
+		if (file == nullptr)
+		{
+			return false;
+		}
+
+		i64_t size = get_file_size(file);
+		bool result = size == 0;
+
+		if (size > 0)
+		{
+			char* data = (char*)alloc_mem((size_t)size);
+			i64_t pos = 0;
+
+			while (pos < size)
+			{
+				u32_t chunk = (u32_t)min_of<i64_t>(size - pos, UINT32_MAX);
+				u32_t read_size = read_file(file, chunk, data + pos);
+
+				if (read_size == 0)
+				{
+					break;
+				}
+
+				pos += read_size;
+			}
+
+			if (pos == size)
+			{
+				intern_lines(data, (size_t)size);
+				result = true;
+			}
+
+			free_mem(data);
+		}
+
+		close_file(file);
+		return result;
+	}
+}
@@ -0,0 +1,197 @@
+#include "ring_buffer.h"
+
+#pragma warning(push, 0)
+
+#define WIN32_LEAN_AND_MEAN
+#define STRICT
+#include <windows.h>
+
+#pragma warning(pop)
+
+namespace aux
+{
+	static const i32_t max_map_attempts = 16;
+
+	struct ring_buffer_t
+	{
+		HANDLE mapping;
+		u8_t* base;
+		size_t capacity;
+		alignas(cache_line_size) volatile LONG64 write_pos;
+		alignas(cache_line_size) volatile LONG64 read_pos;
+	};
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Helper functions
+	//
+	///////////////////////////////////////////////////////////
+
+	static size_t get_allocation_granularity()
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return (size_t)info.dwAllocationGranularity;
+	}
+
+	static u8_t* map_twice(HANDLE mapping, size_t capacity)
+	{
+		for (i32_t i = 0; i < max_map_attempts; ++i)
+		{
+			u8_t* base = (u8_t*)VirtualAlloc(nullptr, capacity * 2, MEM_RESERVE, PAGE_NOACCESS);
+
+			if (base == nullptr)
+			{
+				return nullptr;
+			}
+
+			// The range is free between release and mapping, so another thread may take it and force a retry
+			VirtualFree(base, 0, MEM_RELEASE);
+			void* view1 = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, capacity, base);
+
+			if (view1 != nullptr)
+			{
+				void* view2 = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, capacity, base + capacity);
+
+				if (view2 != nullptr)
+				{
+					return base;
+				}
+
+				UnmapViewOfFile(view1);
+			}
+		}
+
+		return nullptr;
+	}
+
+	// 32-bit builds have no plain 64-bit loads, so a compare with itself reads the position in one piece
+	static LONG64 load_pos(const volatile LONG64* pos)
+	{
+		#if defined(_M_X64)
+		return *pos;
+		#else
+		return InterlockedCompareExchange64((volatile LONG64*)pos, 0, 0);
+		#endif
+	}
+
+	static size_t get_used(const ring_buffer_t* ring)
+	{
+		return (size_t)(load_pos(&ring->write_pos) - load_pos(&ring->read_pos));
+	}
+
+	///////////////////////////////////////////////////////////
+	//
+	//	Ring buffer functions
+	//
+	///////////////////////////////////////////////////////////
+
+	ring_buffer_t* create_ring_buffer(size_t capacity)
+	{
+		AUX_DEBUG_ASSERT((capacity > 0) && (capacity <= SIZE_MAX / 4));
+
+		// A power of two capacity lets positions wrap with a mask, it is also a multiple of the granularity once above it
+		size_t granularity = get_allocation_granularity();
+		size_t size = granularity;
+
+		while (size < capacity)
+		{
+			size *= 2;
+		}
+
+		capacity = size;
+		HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((u64_t)capacity >> 32), (DWORD)capacity, nullptr);
+
+		if (mapping != nullptr)
+		{
+			u8_t* base = map_twice(mapping, capacity);
+
+			if (base != nullptr)
+			{
+				ring_buffer_t* ring = (ring_buffer_t*)zalloc_mem_aligned(sizeof(ring_buffer_t), cache_line_size);
+				ring->mapping = mapping;
+				ring->base = base;
+				ring->capacity = capacity;
+				return ring;
+			}
+
+			CloseHandle(mapping);
+		}
+
+		return nullptr;
+	}
+
+	void destroy_ring_buffer(ring_buffer_t* ring)
+	{
+		UnmapViewOfFile(ring->base + ring->capacity);
+		UnmapViewOfFile(ring->base);
+		CloseHandle(ring->mapping);
+		free_mem_aligned(ring);
+	}
+
+	size_t get_ring_buffer_capacity(const ring_buffer_t* ring)
+	{
+		return ring->capacity;
+	}
+
+	size_t get_ring_buffer_size(const ring_buffer_t* ring)
+	{
+		return get_used(ring);
+	}
+
+	void* begin_ring_buffer_write(ring_buffer_t* ring, size_t& size)
+	{
+		size = ring->capacity - get_used(ring);
+		return ring->base + ((size_t)load_pos(&ring->write_pos) & (ring->capacity - 1));
+	}
+
+	void end_ring_buffer_write(ring_buffer_t* ring, size_t size)
+	{
+		AUX_DEBUG_ASSERT(size <= ring->capacity - get_used(ring));
+
+		InterlockedExchange64(&ring->write_pos, load_pos(&ring->write_pos) + (LONG64)size);
+	}
+
+	const void* begin_ring_buffer_read(ring_buffer_t* ring, size_t& size)
+	{
+		size = get_used(ring);
+		return ring->base + ((size_t)load_pos(&ring->read_pos) & (ring->capacity - 1));
+	}
+
+	void end_ring_buffer_read(ring_buffer_t* ring, size_t size)
+	{
+		AUX_DEBUG_ASSERT(size <= get_used(ring));
+
+		InterlockedExchange64(&ring->read_pos, load_pos(&ring->read_pos) + (LONG64)size);
+	}
+
+	size_t write_ring_buffer(ring_buffer_t* ring, size_t size, const void* data)
+	{
+		size_t available;
+		void* dst = begin_ring_buffer_write(ring, available);
+		size = min_of(size, available);
+
+		if (size > 0)
+		{
+			copy_mem(data, dst, size);
+			end_ring_buffer_write(ring, size);
+		}
+
+		return size;
+	}
+
+	size_t read_ring_buffer(ring_buffer_t* ring, size_t size, void* data)
+	{
+		size_t available;
+		const void* src = begin_ring_buffer_read(ring, available);
+		size = min_of(size, available);
+
+		if (size > 0)
+		{
+			copy_mem(src, data, size);
+			end_ring_buffer_read(ring, size);
+		}
+
+		return size;
+	}
+}
@@ -8,6 +8,8 @@
 
 #pragma warning(pop)
 
+#pragma comment(lib, "synchronization.lib")
+
 namespace aux
 {
 	struct thread_state_t
@@ -21,6 +23,8 @@ namespace aux
 		HANDLE handle;
 	};
 
+	static_assert(sizeof(lock_t) == sizeof(SRWLOCK), "lock_t must match SRWLOCK");
+
 	///////////////////////////////////////////////////////////
 	//
 	//	Helper functions
@@ -42,10 +46,22 @@ namespace aux
 		return (DWORD)msec;
 	}
 
+	static bool set_numa_affinity(HANDLE handle, u32_t node)
+	{
+		GROUP_AFFINITY affinity = {};
+
+		if ((node >= get_numa_node_count()) || !GetNumaNodeProcessorMaskEx((USHORT)node, &affinity) || (affinity.Mask == 0))
+		{
+			return false;
+		}
+
+		return SetThreadGroupAffinity(handle, &affinity, nullptr) != FALSE;
+	}
+
 	__declspec(nothrow) static DWORD WINAPI on_thread(LPVOID param)
 	{
 		thread_state_t state = *(thread_state_t*)param;
-		free_mem(param);
+		free_small_mem(param, sizeof(thread_state_t));
 		return (DWORD)state.handler(state.user_ptr);
 	}
 
@@ -59,7 +75,7 @@ namespace aux
 	{
 		AUX_DEBUG_ASSERT(handler != nullptr);
 
-		thread_state_t* state = (thread_state_t*)alloc_mem(sizeof(thread_state_t));
+		thread_state_t* state = (thread_state_t*)alloc_small_mem(sizeof(thread_state_t));
 		state->handler = handler;
 		state->user_ptr = user_ptr;
 		HANDLE handle = CreateThread(nullptr, 0, &on_thread, state, CREATE_SUSPENDED, nullptr);
@@ -68,7 +84,7 @@ namespace aux
 		{
 			if (ResumeThread(handle) != (DWORD)-1)
 			{
-				thread_t* thread = (thread_t*)alloc_mem(sizeof(thread_t));
+				thread_t* thread = (thread_t*)alloc_small_mem(sizeof(thread_t));
 				thread->handle = handle;
 				return thread;
 			}
@@ -76,14 +92,14 @@ namespace aux
 			CloseHandle(handle);
 		}
 
-		free_mem(state);
+		free_small_mem(state, sizeof(thread_state_t));
 		return nullptr;
 	}
 
 	void free_thread(thread_t* thread)
 	{
 		CloseHandle(thread->handle);
-		free_mem(thread);
+		free_small_mem(thread, sizeof(thread_t));
 	}
 
 	void wait_thread(thread_t* thread)
@@ -96,8 +112,70 @@ namespace aux
 		return WaitForSingleObject(thread->handle, get_timeout(timeout_msec)) == WAIT_OBJECT_0;
 	}
 
+	bool bind_thread_to_numa_node(thread_t* thread, u32_t node)
+	{
+		return set_numa_affinity(thread->handle, node);
+	}
+
+	bool bind_current_thread_to_numa_node(u32_t node)
+	{
+		if (!set_numa_affinity(GetCurrentThread(), node))
+		{
+			return false;
+		}
+
+		// Node allocations from this thread now default to the node it runs on
+		set_thread_numa_node((i32_t)node);
+		return true;
+	}
+
 	void suspend_current_thread(u32_t duration_msec)
 	{
 		Sleep(get_timeout(duration_msec));
 	}
+
+	void wait_on_value(const volatile u32_t* address, u32_t value)
+	{
+		WaitOnAddress((volatile void*)address, &value, sizeof(u32_t), INFINITE);
+	}
+
+	bool wait_on_value(const volatile u32_t* address, u32_t value, u32_t timeout_msec)
+	{
+		return WaitOnAddress((volatile void*)address, &value, sizeof(u32_t), get_timeout(timeout_msec)) != FALSE;
+	}
+
+	void wake_single_waiter(const volatile u32_t* address)
+	{
+		WakeByAddressSingle((PVOID)address);
+	}
+
+	void wake_all_waiters(const volatile u32_t* address)
+	{
+		WakeByAddressAll((PVOID)address);
+	}
+
+	void acquire_lock(lock_t& lock)
+	{
+		AcquireSRWLockExclusive((PSRWLOCK)&lock);
+	}
+
+	bool try_acquire_lock(lock_t& lock)
+	{
+		return TryAcquireSRWLockExclusive((PSRWLOCK)&lock) != FALSE;
+	}
+
+	void release_lock(lock_t& lock)
+	{
+		ReleaseSRWLockExclusive((PSRWLOCK)&lock);
+	}
+
+	void acquire_shared_lock(lock_t& lock)
+	{
+		AcquireSRWLockShared((PSRWLOCK)&lock);
+	}
+
+	void release_shared_lock(lock_t& lock)
+	{
+		ReleaseSRWLockShared((PSRWLOCK)&lock);
+	}
 }